@@ -0,0 +1,115 @@
+#ifndef AUTOREGLAGE_H
+#define AUTOREGLAGE_H
+
+#include "virgule_fixe.h"
+
+//Réglage automatique du correcteur PD par essai en relais (méthode d'Åström-Hägglund)
+//Pendant l'essai la commande différentielle vaut +AMPLITUDE ou -AMPLITUDE selon le côté
+//de la ligne (avec hystérésis) : le robot oscille autour de la ligne à sa période
+//critique. La période Tu et l'amplitude a de l'oscillation donnent le gain critique
+//Ku = 4*AMPLITUDE / (pi*sqrt(a²-h²)), puis les gains par Ziegler-Nichols (PD) :
+//KP = 0.8*Ku, KD = KP*Tu/8
+//Aucun accès au matériel : l'essai se rejoue sur PC comme le reste du cycle
+//Unités de estimation.h : position en pas de capteur Q24, temps en cycles de contrôle
+//Calcul entier : l'essai tourne dans le cycle de contrôle
+
+enum {
+	REGLAGE_EN_COURS = 0,
+	REGLAGE_REUSSI = 1,
+	REGLAGE_ECHEC = 2
+};
+
+class ReglageRelais {
+public:
+	enum {
+		//Commande différentielle du relais (‰)
+		AMPLITUDE = 300,
+		//Hystérésis : 0.15 pas, au-dessus du bruit de la position estimée
+		HYSTERESE = (3 << 24) / 20,
+		//Oscillations d'établissement ignorées, puis oscillations mesurées
+		OSCILLATIONS_IGNOREES = 2,
+		OSCILLATIONS = 4,
+		//Durée maximale de l'essai (cycles) et perte de ligne tolérée
+		DUREE_MAX = 5000,
+		CYCLES_SANS_LIGNE = 50
+	};
+
+	ReglageRelais() : etat_(REGLAGE_EN_COURS), sortie(1), cycles(0), dernier_basculement(-1),
+		oscillations(0), haut(0), bas(0), somme_periodes(0), somme_crete(0), kp_(0), kd_(0) {}
+
+	//Un cycle de l'essai : commande différentielle à appliquer (‰, droite - gauche)
+	//position : position estimée de la ligne (Q24), sans_ligne : cycles sans mesure
+	int commande(int position, int sans_ligne){
+		if(etat_ != REGLAGE_EN_COURS)
+			return 0;
+		if(++cycles > DUREE_MAX || sans_ligne > CYCLES_SANS_LIGNE){
+			etat_ = REGLAGE_ECHEC;
+			return 0;
+		}
+		if(position > haut)
+			haut = position;
+		if(position < bas)
+			bas = position;
+
+		//Ligne à gauche (position négative) -> moteur droit plus rapide (commande positive)
+		if(sortie < 0 && position < -HYSTERESE){
+			sortie = 1;
+			//Une période complète entre deux basculements dans le même sens
+			if(dernier_basculement >= 0 && ++oscillations > OSCILLATIONS_IGNOREES){
+				somme_periodes += cycles - dernier_basculement;
+				somme_crete += (long long)haut - bas;
+			}
+			dernier_basculement = cycles;
+			haut = bas = position;
+			if(oscillations == OSCILLATIONS_IGNOREES + OSCILLATIONS)
+				calcule_gains();
+		}
+		else if(sortie > 0 && position > HYSTERESE)
+			sortie = -1;
+		return sortie * AMPLITUDE;
+	}
+
+	int etat() const { return etat_; }
+	//Gains trouvés (unités de PilotagePD)
+	int kp() const { return kp_; }
+	int kd() const { return kd_; }
+	//Période (cycles) et amplitude (pas, Q12) de l'oscillation mesurée
+	int periode() const { return somme_periodes / OSCILLATIONS; }
+	int amplitude() const { return (int)((somme_crete / (2 * OSCILLATIONS)) >> 12); }
+
+private:
+	//Amplitude et hystérésis en Q12 : la racine de a²-h² (Q24, sur 64 bits : a dépasse
+	//46340, 11 pas, sur une barrette large) est en Q12, et
+	//KP = 0.8*4/pi * AMPLITUDE / racine, KD = KP * somme des périodes / (8*OSCILLATIONS)
+	void calcule_gains(){
+		int a = amplitude(), h = HYSTERESE >> 12;
+		if(a <= h){
+			etat_ = REGLAGE_ECHEC;
+			return;
+		}
+		int r = (int)racine((unsigned long long)((long long)a*a - (long long)h*h));
+		long long kp = (long long)AMPLITUDE * EN_Q(0.8 * 4 / 3.14159265, 12);
+		kp_ = (int)((kp + r/2) / r);
+		kd_ = (int)((kp * somme_periodes + 4LL * OSCILLATIONS * r) / (8LL * OSCILLATIONS * r));
+		etat_ = (kp_ > 0 && kd_ >= 0) ? REGLAGE_REUSSI : REGLAGE_ECHEC;
+	}
+
+	int etat_;
+	//Sens du relais (+1 : tourne à gauche)
+	int sortie;
+	//Cycles depuis le début de l'essai, date du dernier basculement vers +1
+	int cycles;
+	int dernier_basculement;
+	//Périodes complètes vues
+	int oscillations;
+	//Extrema de la position pendant la période en cours (Q24)
+	int haut;
+	int bas;
+	//Sommes sur les périodes mesurées (crêtes en Q24 : 64 bits)
+	int somme_periodes;
+	long long somme_crete;
+	int kp_;
+	int kd_;
+};
+
+#endif
@@ -0,0 +1,152 @@
+#ifndef BOITE_NOIRE_H
+#define BOITE_NOIRE_H
+
+#include "parametres.h"
+
+//Boîte noire : mémoire circulaire des derniers cycles de contrôle
+//Un enregistrement par cycle (temps capteurs, décision, vitesses, date)
+//Elle se fige sur perte de ligne, appui sur le bouton ou défaut matériel
+//pour garder ce qui s'est passé juste avant ; le contenu est ensuite vidé
+//sur la liaison série ou dans un fichier et décodé sur PC (outils/decode_boite.cpp)
+//Ce fichier ne dépend pas de mbed : le format est partagé avec l'outil de décodage
+
+//Causes de gel de la boîte noire
+enum {
+	GEL_AUCUN = 0,
+	GEL_PERTE_LIGNE = 1,
+	GEL_BOUTON = 2,
+	GEL_DEFAUT = 3,
+	GEL_ECHEANCE = 4	//boucle de contrôle bloquée, moteurs coupés (surveillance.h)
+};
+
+//Masque des capteurs sur la ligne, un bit par capteur
+#if NB_CAPTEURS <= 8
+typedef unsigned char MasqueCycle;
+#elif NB_CAPTEURS <= 16
+typedef unsigned short MasqueCycle;
+#else
+typedef unsigned int MasqueCycle;
+#endif
+
+//Un cycle de contrôle (24 octets pour 6 capteurs, sans trou d'alignement)
+//La date ne garde que les 32 bits de poids faible (différences justes sur 71 minutes) :
+//la boîte garde les 32 bits de poids fort de la date du dernier enregistrement
+struct Enregistrement {
+	unsigned int date_us;
+	unsigned short temps_us[NB_CAPTEURS];
+	//Vitesses des moteurs en pour mille de la période PWM
+	unsigned short droite;
+	unsigned short gauche;
+	signed char direction;
+	unsigned char confiance;
+	MasqueCycle masque;
+	unsigned char cause;
+};
+
+//Entête des données vidées (fichier binaire)
+struct EnteteBoiteNoire {
+	char magie[4];		//"BNR2"
+	unsigned short taille_enregistrement;
+	unsigned short nombre;
+	unsigned short cause;
+	unsigned short nombre_capteurs;
+	unsigned int date_poids_fort;	//date du dernier enregistrement, 32 bits de poids fort
+};
+
+//Nombre d'enregistrements dans une banque AHB de 16 Ko
+#define TAILLE_BOITE_NOIRE (0x4000/sizeof(Enregistrement))
+
+class BoiteNoire {
+public:
+	BoiteNoire(Enregistrement *tampon, int taille)
+		: tampon(tampon), taille(taille), suivant(0), nombre_(0), date_poids_fort_(0), cause_(GEL_AUCUN),
+		  fige_(false), apres(0), sans_ligne(0), vidage(false) {}
+
+	//Ajoute un cycle (sans effet si la boîte est figée), daté de date_poids_fort:e.date_us
+	void enregistre(const Enregistrement &e, unsigned int date_poids_fort){
+		if(fige_)
+			return;
+		tampon[suivant] = e;
+		date_poids_fort_ = date_poids_fort;
+		suivant = (suivant + 1 == taille) ? 0 : suivant + 1;
+		if(nombre_ < taille)
+			nombre_++;
+
+		//Perte de ligne : on garde encore un quart de la boîte pour voir la suite
+		if(e.confiance == 0){
+			if(++sans_ligne == CYCLES_PERTE_LIGNE && cause_ == GEL_AUCUN){
+				cause_ = GEL_PERTE_LIGNE;
+				apres = taille/4;
+			}
+		}
+		else
+			sans_ligne = 0;
+		if(cause_ != GEL_AUCUN && --apres <= 0)
+			fige_ = true;
+	}
+
+	//Gel immédiat (interruption bouton, défaut) ; le premier gel garde sa cause
+	void fige(int cause){
+		if(cause_ == GEL_AUCUN)
+			cause_ = cause;
+		fige_ = true;
+	}
+
+	//Appui sur le bouton pendant la course : gel et demande de vidage
+	void appui(){
+		if(nombre_ == 0)
+			return;
+		fige(GEL_BOUTON);
+		vidage = true;
+	}
+
+	bool vidage_demande() const { return vidage; }
+	bool figee() const { return fige_; }
+	int cause() const { return cause_; }
+	int nombre() const { return nombre_; }
+	unsigned int date_poids_fort() const { return date_poids_fort_; }
+
+	//i-ème enregistrement, du plus ancien (0) au plus récent (nombre()-1)
+	const Enregistrement &lit(int i) const {
+		int j = suivant - nombre_ + i;
+		if(j < 0)
+			j += taille;
+		return tampon[j];
+	}
+
+	//Boîte vidée : on recommence à enregistrer
+	void rearme(){
+		nombre_ = 0;
+		suivant = 0;
+		date_poids_fort_ = 0;
+		sans_ligne = 0;
+		apres = 0;
+		cause_ = GEL_AUCUN;
+		vidage = false;
+		fige_ = false;
+	}
+
+private:
+	enum {
+		//Cycles consécutifs sans ligne avant de figer la boîte
+		CYCLES_PERTE_LIGNE = 50
+	};
+
+	Enregistrement *tampon;
+	int taille;
+	//Prochaine case à écrire
+	int suivant;
+	//Nombre d'enregistrements valides
+	int nombre_;
+	//32 bits de poids fort de la date du dernier enregistrement
+	unsigned int date_poids_fort_;
+	volatile int cause_;
+	volatile bool fige_;
+	//Enregistrements restant à faire après le déclenchement
+	int apres;
+	//Cycles consécutifs sans ligne
+	int sans_ligne;
+	volatile bool vidage;
+};
+
+#endif
@@ -0,0 +1,88 @@
+#ifndef BOITE_NOIRE_VIDAGE_H
+#define BOITE_NOIRE_VIDAGE_H
+
+#include "mbed.h"
+#include <stdio.h>
+#include "parametres.h"
+#include "boite_noire.h"
+
+//Vidage de la boîte noire
+//Liaison série : écriture directe dans l'UART0 par scrutation, sans printf ni interruption,
+//utilisable depuis un gestionnaire de défaut. Format texte :
+//	BOITE_NOIRE debut <cause> <nombre> <taille enregistrement> <nombre de capteurs> <date, poids fort>
+//	<un enregistrement en hexadécimal par ligne, du plus ancien au plus récent>
+//	BOITE_NOIRE fin
+//Fichier (LocalFileSystem) : entête EnteteBoiteNoire puis les enregistrements bruts
+
+//Envoi d'un caractère sur l'UART0 en attendant que la FIFO d'émission soit vide
+inline void uart_envoie(char c){
+	while(!(LPC_UART0->LSR & (1<<5)));
+	LPC_UART0->THR = c;
+}
+
+inline void uart_texte(const char *texte){
+	while(*texte)
+		uart_envoie(*texte++);
+}
+
+inline void uart_hex(const unsigned char *octets, int n){
+	static const char chiffres[] = "0123456789ABCDEF";
+	int i;
+	for(i=0; i<n; i++){
+		uart_envoie(chiffres[octets[i] >> 4]);
+		uart_envoie(chiffres[octets[i] & 0xF]);
+	}
+}
+
+inline void uart_entier(unsigned int n){
+	char texte[11];
+	int i = 10;
+	texte[i] = 0;
+	do{
+		texte[--i] = '0' + n%10;
+		n /= 10;
+	}while(n);
+	uart_texte(&texte[i]);
+}
+
+inline void vide_boite_serie(const BoiteNoire &boite){
+	int i;
+	uart_texte("\r\nBOITE_NOIRE debut ");
+	uart_entier(boite.cause());
+	uart_envoie(' ');
+	uart_entier(boite.nombre());
+	uart_envoie(' ');
+	uart_entier(sizeof(Enregistrement));
+	uart_envoie(' ');
+	uart_entier(NB_CAPTEURS);
+	uart_envoie(' ');
+	uart_entier(boite.date_poids_fort());
+	uart_texte("\r\n");
+	for(i=0; i<boite.nombre(); i++){
+		uart_hex((const unsigned char *)&boite.lit(i), sizeof(Enregistrement));
+		uart_texte("\r\n");
+	}
+	uart_texte("BOITE_NOIRE fin\r\n");
+}
+
+#if BOITE_NOIRE_FICHIER
+//Le fichier n'est accessible que si le microcontrôleur n'a jamais dormi
+//(sleep() déconnecte l'interface mbed : voir sleep_api.h)
+inline bool vide_boite_fichier(const BoiteNoire &boite, const char *nom){
+	EnteteBoiteNoire entete = {{'B', 'N', 'R', '2'}, sizeof(Enregistrement), 0, 0, NB_CAPTEURS, 0};
+	int i;
+	FILE *f = fopen(nom, "wb");
+	if(!f)
+		return false;
+	entete.nombre = boite.nombre();
+	entete.cause = boite.cause();
+	entete.date_poids_fort = boite.date_poids_fort();
+	fwrite(&entete, sizeof(entete), 1, f);
+	for(i=0; i<boite.nombre(); i++)
+		fwrite(&boite.lit(i), sizeof(Enregistrement), 1, f);
+	fclose(f);
+	return true;
+}
+#endif
+
+#endif
@@ -0,0 +1,67 @@
+#ifndef CADENCE_H
+#define CADENCE_H
+
+#include "mbed.h"
+#include "parametres.h"
+#include "memoire.h"
+#include "priorites.h"
+
+//Tick du cycle de contrôle sur un timer qui lui est réservé (TIMER1), à la priorité
+//PRIORITE_CADENCE : le Ticker de mbed partage le TIMER3 (us_ticker) avec la surveillance,
+//l'horloge et les Timeout, et chaque événement y passe par la liste triée de mbed
+//Le compteur repart de zéro à chaque tick (MR0) : lu à l'entrée de l'interruption,
+//il date le tick pour la mesure de latence (MESURE_LATENCE)
+class CadenceControle {
+public:
+	//Même usage que Ticker::attach_us()
+	template<typename T>
+	void attach_us(T *objet, void (T::*methode)(void), unsigned int periode_us){
+		fonction.attach(objet, methode);
+		instance = this;
+		//TIMER1 alimenté, horloge CCLK/4, sans prédiviseur
+		LPC_SC->PCONP |= (1<<2);
+		LPC_SC->PCLKSEL0 &= ~(3<<4);
+		LPC_TIM1->TCR = 2;
+		LPC_TIM1->PR = 0;
+		LPC_TIM1->MR0 = SystemCoreClock/4/1000000 * periode_us - 1;
+		//Interruption et remise à zéro sur MR0
+		LPC_TIM1->MCR = 3;
+		NVIC_SetVector(TIMER1_IRQn, (uint32_t)&CadenceControle::interruption);
+		NVIC_EnableIRQ(TIMER1_IRQn);
+		LPC_TIM1->TCR = 1;
+	}
+
+	//Plus de tick (robot garé, sommeil profond) puis reprise d'une période complète
+	void arrete(){
+		NVIC_DisableIRQ(TIMER1_IRQn);
+		LPC_TIM1->TCR = 0;
+		LPC_TIM1->IR = 1;
+		NVIC_ClearPendingIRQ(TIMER1_IRQn);
+	}
+
+	void reprend(){
+		LPC_TIM1->TCR = 2;
+		NVIC_EnableIRQ(TIMER1_IRQn);
+		LPC_TIM1->TCR = 1;
+	}
+
+private:
+	//Interruption TIMER1
+	EN_RAM static void interruption(){
+#if MESURE_LATENCE
+		//Coups de CCLK/4 depuis le tick
+		unsigned int ecoule = LPC_TIM1->TC;
+#endif
+		LPC_TIM1->IR = 1;
+#if MESURE_LATENCE
+		latence_cycle.evenement(ecoule * 4);
+#endif
+		instance->fonction.call();
+	}
+
+	FunctionPointer fonction;
+	//Instance servie par l'interruption (main.cpp)
+	static CadenceControle *instance;
+};
+
+#endif
@@ -0,0 +1,199 @@
+#ifndef CALIBRAGE_H
+#define CALIBRAGE_H
+
+#include "mbed.h"
+#include "parametres.h"
+#include "fifo.h"
+#include "chaine_appels.h"
+
+//Stratégies de calibrage du seuil de différenciation ligne/sol
+//evenements() -> prise en compte des actions de l'utilisateur (boucle principale)
+//en_attente() -> robot à l'arrêt, en attente d'une action de l'utilisateur
+//en_cours()   -> une mesure de calibrage doit être faite (mesure())
+//seuil()      -> seuil commun à utiliser pour la décision
+//niveau_noir(i), niveau_blanc(i) -> temps de référence du capteur i sur le sol et sur la ligne
+//ajoute_appui() -> fonction supplémentaire appelée sous interruption à chaque appui (s'il y a un bouton)
+//reglage_demande() -> vrai une fois si le départ demande un essai de réglage (AUTO_REGLAGE)
+
+//Seuil fixe (ancien main1.cpp) : le robot part directement
+template<int SEUIL>
+class CalibrageFixe {
+public:
+	void init(){}
+	void evenements(){}
+	bool en_attente() const { return false; }
+	bool en_cours() const { return false; }
+	void mesure(const int temps_us[NB_CAPTEURS]){}
+	int seuil() const { return SEUIL; }
+	//Niveaux inconnus : on part du seuil, le suivi en course les sépare
+	int niveau_noir(int i) const { return SEUIL; }
+	int niveau_blanc(int i) const { return SEUIL; }
+	//Pas de bouton
+	template<typename T>
+	void ajoute_appui(T *objet, void (T::*methode)(void)){}
+	bool reglage_demande(){ return false; }
+};
+
+//Calibrage au bouton poussoir (ancien main2.cpp)
+//1er appui -> calibrage "noir"
+//2e  appui -> calbrage "blanc"
+//3e  appui -> lancement robot (maintenu 1s avec AUTO_REGLAGE : essai de réglage au départ)
+//L'interruption du bouton ne fait que déposer l'appui dans une file,
+//traitée ensuite par la boucle principale (les attentes ne bloquent plus les interruptions)
+class CalibrageBouton {
+public:
+	CalibrageBouton() : boutton(D8), count_button(0), calibre(false), reglage(false), min(0), max(0), seuil_(800){ //800 valeur de "défaut"
+		char i;
+		for(i=0; i<NB_CAPTEURS; i++){
+			noir[i] = seuil_;
+			blanc[i] = seuil_;
+		}
+	}
+
+	void init(){
+		//On relie le bouton (interruption) à la chaîne des fonctions d'appui
+		sur_appui.add_front(this, &CalibrageBouton::appui);
+		boutton.rise(&sur_appui, &ChaineAppels<APPELS_BOUTON>::call);
+		//On initialise les LEDs témoins
+		init_GPIO();
+	}
+
+	//Traitement des appuis sur le bouton poussoir
+	void evenements(){
+		char e;
+		while(appuis.retire(e))
+			calibrage();
+	}
+
+	//Robot arrêté tant qu'aucun appui n'est à traiter
+	bool en_attente() const { return !calibre && appuis.vide(); }
+	bool en_cours() const { return count_button == 1 || count_button == 2; }
+
+	//Exploite une lecture des capteurs pour l'étape de calibrage en cours
+	void mesure(const int temps_us[NB_CAPTEURS]){
+		//Calibrage "noir"
+		if(count_button == 1){
+			copie_temps(temps_us, noir);
+			minimum_temps(temps_us);
+			calibre = false;
+		}
+		//Calibrage blanc + Réglage seuil
+		else if(count_button == 2){
+			copie_temps(temps_us, blanc);
+			maximum_temps(temps_us);
+		
+			seuil_ = (min+max)/2;
+			wait(1);
+			//LED jaune témoin seuil
+			LPC_GPIO1->FIOCLR |= (1<<23);
+			calibre = false;
+			
+			//"Attente" pour voir les LEDs allumées
+			wait(1);
+			//Eteinte des LEDs avant le départ du robot
+			LPC_GPIO1->FIOSET |= (1<<18)|(1<<21)|(1<<23);
+		}
+	}
+
+	int seuil() const { return seuil_; }
+	int niveau_noir(int i) const { return noir[i]; }
+	int niveau_blanc(int i) const { return blanc[i]; }
+
+	//Autres fonctions à appeler sous interruption lors d'un appui
+	template<typename T>
+	void ajoute_appui(T *objet, void (T::*methode)(void)){
+		sur_appui.add(objet, methode);
+	}
+
+	//Départ avec le bouton maintenu : à lire une fois au début de la course
+	bool reglage_demande(){
+		bool r = reglage;
+		reglage = false;
+		return r;
+	}
+
+private:
+	//Nombre maximal de fonctions appelées à l'appui
+	enum { APPELS_BOUTON = 4 };
+
+	//Initialisation des LEDs témoins du calibrage
+	void init_GPIO(){
+		//Réglage LEDs témoin calibrage
+		LPC_GPIO1->FIODIR |= (1<<18)|(1<<21)|(1<<23); //On met les 4 LEDs de la carte en sortie.
+		LPC_GPIO1->FIOCLR |= (1<<18)|(1<<21)|(1<<23); //On allume les LEDs comme témoin
+		wait(2);
+		LPC_GPIO1->FIOSET |= (1<<18)|(1<<21)|(1<<23); //On éteint les LEDs
+	}
+
+	//Appui sur le bouton poussoir (interruption)
+	void appui(){
+		appuis.ajoute(1);
+	}
+
+	//Prise en compte d'un appui
+	void calibrage(){
+		if(count_button < 2)
+			wait(1);
+#if AUTO_REGLAGE
+		//Départ : bouton encore enfoncé après 1s -> essai de réglage
+		else if(count_button == 2){
+			wait(1);
+			reglage = boutton.read();
+		}
+#endif
+		count_button++;
+		calibre = true;
+	}
+
+	//Mémorise la lecture de chaque capteur
+	void copie_temps(const int temps_us[NB_CAPTEURS], int niveaux[NB_CAPTEURS]){
+		char i;
+		for(i=0; i<NB_CAPTEURS; i++)
+			niveaux[i] = temps_us[i];
+	}
+
+	//Récupère le minimum des capteurs pour la couleur "extérieur"
+	void minimum_temps(const int temps_us[NB_CAPTEURS]){
+		char i;
+		min = 10000;
+		for(i=0; i<NB_CAPTEURS; i++){
+			if(temps_us[i] < min)
+				min = temps_us[i];
+		}
+		//LED verte témoin
+		LPC_GPIO1->FIOCLR |= (1<<18);
+	}
+	//Récupère le maximum des capteurs pour la couleur de la ligne (blanche)
+	void maximum_temps(const int temps_us[NB_CAPTEURS]){
+		char i;
+		max = 0;
+		for(i=0; i<NB_CAPTEURS; i++){
+			if(temps_us[i] > max)
+				max = temps_us[i];
+		}
+		//LED bleu témoin
+		LPC_GPIO1->FIOCLR |= (1<<21);
+	}
+
+	//Interruption boutton pour le calibrage
+	InterruptIn boutton;
+	//Fonctions appelées à chaque appui (calibrage en premier)
+	ChaineAppels<APPELS_BOUTON> sur_appui;
+	//Appuis sur le bouton, de l'interruption vers la boucle principale
+	FileSPSC<char, 4> appuis;
+	//Variable compte appuie sur le bouton
+	char count_button;
+	//Variable pour calibrer les capteurs une seule fois
+	bool calibre;
+	//Essai de réglage demandé au départ
+	bool reglage;
+	//Variables temps maximum et minimum pour le calibrage
+	int min, max;
+	//Variable seuil différenciation ligne/sol
+	int seuil_;
+	//Lectures de chaque capteur lors des calibrages "noir" et "blanc"
+	int noir[NB_CAPTEURS];
+	int blanc[NB_CAPTEURS];
+};
+
+#endif
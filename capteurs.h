@@ -0,0 +1,456 @@
+#ifndef CAPTEURS_H
+#define CAPTEURS_H
+
+#include "mbed.h"
+#include "pinmap.h"
+#include "gpio_api.h"
+#include "analogin_api.h"
+#include "cmsis_nvic.h"
+#include "parametres.h"
+#include "memoire.h"
+#include "priorites.h"
+#include "fifo.h"
+#include "gamme.h"
+
+/*
+	C1 (5)		: Blanc 	| P0.23 <=> p15
+	C2 (A2)		: Violet	| P0.24 <=> p16
+	C3 (A0)		: Bleu		| P0.25 <=> p17
+	C4 (11)		: Vert		| P0.26 <=> p18
+	C5 (A3)		: Jaune		| P1.30 <=> p19
+	C6 (4)		: Orange	| P1.31 <=> p20
+	LEDON		: Gris		| P2.5  <=> p21	(émetteurs IR, allumés à 1)
+*/
+
+//Liste des broches des capteurs, de gauche à droite (bit i des masques <=> capteur i+1)
+//Les masques des ports GPIO et l'extraction des niveaux sont calculés à la compilation :
+//ajouter des capteurs ne change que cette liste et NB_CAPTEURS (parametres.h)
+struct FinBroches {
+	enum { N = 0 };
+	template<int P>
+	struct Masque {
+		enum { valeur = 0 };
+	};
+	static PinName broche(int i){ return NC; }
+	static unsigned int bas(const unsigned int niveaux[5]){ return 0; }
+};
+
+template<PinName BROCHE, class Suite = FinBroches>
+struct Broches {
+	enum {
+		N = Suite::N + 1,
+		PORT = (BROCHE - P0_0) >> PORT_SHIFT,
+		BIT = (BROCHE - P0_0) & 31
+	};
+	//Broches de la liste sur le port P
+	template<int P>
+	struct Masque {
+		enum { valeur = (P == PORT ? 1u << BIT : 0u) | (unsigned int)Suite::template Masque<P>::valeur };
+	};
+	static PinName broche(int i){ return i == 0 ? BROCHE : Suite::broche(i-1); }
+	//Capteurs déchargés (entrée à 0) à partir des registres FIOPIN des ports
+	static unsigned int bas(const unsigned int niveaux[5]){
+		return (~niveaux[PORT] >> BIT & 1) | Suite::bas(niveaux) << 1;
+	}
+};
+
+//Barrette du robot (voir le câblage ci-dessus)
+typedef
+	Broches<P0_23, Broches<P0_24, Broches<P0_25,
+	Broches<P0_26, Broches<P1_30, Broches<P1_31
+	> > > > > > BrochesCapteurs;
+
+//Accès groupés aux ports GPIO d'une liste de broches, un registre par port utilisé
+//(les ports sans capteur disparaissent à la compilation)
+template<class Liste, int P = 0>
+struct PortsCapteurs {
+	enum { MASQUE = Liste::template Masque<P>::valeur };
+
+	static LPC_GPIO_TypeDef *gpio(){ return (LPC_GPIO_TypeDef *)(LPC_GPIO0_BASE + P*0x20); }
+
+	//Capteurs en sortie à 1 : charge des capacités
+	static void charge(){
+		if(MASQUE != 0){
+			gpio()->FIOSET = MASQUE;
+			gpio()->FIODIR |= MASQUE;
+		}
+		PortsCapteurs<Liste, P+1>::charge();
+	}
+
+	//Capteurs en entrée : début de la décharge
+	static void decharge(){
+		if(MASQUE != 0)
+			gpio()->FIODIR &= ~MASQUE;
+		PortsCapteurs<Liste, P+1>::decharge();
+	}
+
+	//Niveaux des ports utilisés
+	static void lecture(unsigned int niveaux[5]){
+		if(MASQUE != 0)
+			niveaux[P] = gpio()->FIOPIN;
+		PortsCapteurs<Liste, P+1>::lecture(niveaux);
+	}
+};
+
+template<class Liste>
+struct PortsCapteurs<Liste, 5> {
+	static void charge(){}
+	static void decharge(){}
+	static void lecture(unsigned int niveaux[5]){}
+};
+
+//Stratégies d'acquisition
+//ASYNCHRONE    -> 0 : lecture() fait la mesure (cadence donnée par le tick du robot, cadence.h)
+//                 1 : les mesures sont faites sous interruption, la boucle suit les trames
+//demarre()     -> lancement de l'acquisition (ou reprise après arrete())
+//arrete()      -> arrêt de l'acquisition, plus aucune interruption (robot garé)
+//trame_prete() -> une nouvelle trame peut être lue sans attendre
+//lecture()     -> temps de descente de la dernière trame
+//purge()       -> oubli des trames déjà mesurées (la prochaine lecture est récente)
+
+//Temps de descente des capteurs pour une lecture complète
+struct Trame {
+	int temps_us[NB_CAPTEURS];
+};
+
+//Acquisition par charge/décharge de la capacité des capteurs photorésistances
+//Les étapes sont faites l'une après l'autre dans la boucle principale
+//Lecture analogique : broches de l'ADC uniquement (p15 à p20)
+template<class Liste>
+class CapteursRC {
+public:
+	enum { ASYNCHRONE = 0 };
+
+	void demarre(){}
+	void arrete(){}
+	bool trame_prete() const { return true; }
+	void purge(){}
+
+	//Cycle complet de lecture des capteurs
+	void lecture(int temps_us[NB_CAPTEURS]){
+		//On charge la capacité de chaque capteur
+		sensorsOut10us();
+		//On mesure le temps de décharge
+		sensorsIn(temps_us);
+	}
+
+private:
+	//Première partie pour un cycle de lecture des capteurs
+	//Chargement de la capacité des capteurs
+	void sensorsOut10us(){
+		char i;
+		//On passe les capteurs en Out et on impose la valeur 1 à chaque capteur
+		gpio_t sensors[NB_CAPTEURS];
+		for(i=0; i<NB_CAPTEURS; i++)
+			gpio_init_out_ex(&sensors[i], Liste::broche(i), 1);
+		//On attend quelques microsecondes pour charger la capacité
+		wait_us(10);
+	}
+
+	//Deuxème partie pour un cycle de lecture des capteurs
+	//Déchargement de la capacité des capteurs et mesure du temps
+	void sensorsIn(int temps_us[NB_CAPTEURS]){
+		//On réinitialise le tableau flagTps
+		char i;
+		for(i=0; i<NB_CAPTEURS; i++)
+			flagTps[i] = false;
+		//Timer pour calculer le temps de décharge
+		Timer time;
+		//On passe les capteurs en In
+		analogin_t sensors[NB_CAPTEURS];
+		for(i=0; i<NB_CAPTEURS; i++)
+			analogin_init(&sensors[i], Liste::broche(i));
+		//On démarre le timer après le passage des capteurs à IN
+		time.start();
+		//On calcule les temps de descente pour chaque capteur
+		bool verification = false;
+		while(!verification){
+			
+			//Gestion condition d'arrêt while
+			for(i=0; i<NB_CAPTEURS; i++){
+				//Mise à jour condition d'arrêt while
+				if(flagTps[i] == true){
+					verification = true;
+				}
+				else{
+					verification = false;
+					break;
+				}
+			}
+				
+			//Récupération des temps de descente des capteurs
+			for(i=0; i<NB_CAPTEURS; i++){
+				if(analogin_read(&sensors[i]) < 0.5 && flagTps[i] == false){
+						temps_us[i] = time.read_us();
+						flagTps[i] = true;
+				}
+			}
+		}
+		//On arrête le timer
+		time.stop();
+	}
+
+	//Tableau flag savoir si le temps de descente a été récupéré
+	bool flagTps[NB_CAPTEURS];
+
+	//La liste des broches doit avoir NB_CAPTEURS éléments (erreur de compilation sinon)
+	typedef char nombre_de_broches[Liste::N == NB_CAPTEURS ? 1 : -1];
+};
+
+//Acquisition en tâche de fond : charge et décharge de la trame N+1 sous interruption
+//pendant que la boucle principale calcule la direction de la trame N
+//Le TIMER2 (1 tick = 1µs) interrompt toutes les PERIODE_US pour échantillonner
+//tous les capteurs en une lecture par port GPIO : la résolution des temps est PERIODE_US
+//Une trame dure la charge (10µs) plus la décharge du capteur le plus lent
+//Un capteur qui ne se décharge pas avant la fin de la fenêtre est lu à la fenêtre (noir)
+//Durée de charge et fenêtre de décharge sont données par Gamme (gamme.h) : fixes
+//(10µs et 5ms) ou réglées à partir des niveaux observés pour raccourcir les trames ;
+//les trames d'essai d'un autre réglage ne sont pas publiées
+//Le seuil est celui d'une entrée numérique (≈ Vdd/2) et non plus AnalogIn < 0.5
+//
+//Rejet de la lumière ambiante (AMBIANT > 0) : une trame sur AMBIANT est mesurée
+//émetteurs IR éteints (broche LEDON) et n'est pas publiée ; elle donne le temps t_off
+//dû à la seule lumière ambiante. Le courant du phototransistor s'ajoute (ambiante + IR)
+//et le temps de décharge lui est inversement proportionnel, donc le temps qu'aurait
+//la seule réflexion des émetteurs est t = t_on*t_off/(t_off - t_on)
+//La trame ambiante est bornée à DECHARGE_AMBIANT_MAX_US : au-delà, l'ambiante est
+//négligeable et le temps n'est pas corrigé. La cadence baisse d'environ 1/AMBIANT
+template<class Liste, int PERIODE_US, int AMBIANT = 0, class Gamme = GammeFixe>
+class CapteursPipeline {
+public:
+	enum { ASYNCHRONE = 1 };
+
+	CapteursPipeline() : phase(CHARGE), debut(0), restants(0), charge_us(0), fenetre_us(0), essai(false), perdues(0), ambiante(false), compteur_ambiant(0) {
+		char i;
+		for(i=0; i<NB_CAPTEURS; i++)
+			ambiant_us[i] = 0;
+	}
+
+	void demarre(){
+		char i;
+		instance = this;
+		//Capteurs en GPIO, sans résistance de tirage (sinon la capacité se recharge)
+		for(i=0; i<NB_CAPTEURS; i++){
+			pin_function(Liste::broche(i), 0);
+			pin_mode(Liste::broche(i), PullNone);
+		}
+		//Émetteurs IR pilotés : sortie, allumés
+		if(AMBIANT){
+			LPC_GPIO2->FIOSET = MASQUE_LEDON;
+			LPC_GPIO2->FIODIR |= MASQUE_LEDON;
+		}
+		//Trames d'avant un arrêt oubliées
+		purge();
+		//TIMER2 alimenté, horloge CCLK/4, 1 tick par µs
+		LPC_SC->PCONP |= (1<<22);
+		LPC_SC->PCLKSEL1 &= ~(3<<12);
+		LPC_TIM2->TCR = 2;
+		LPC_TIM2->PR = SystemCoreClock/4/1000000 - 1;
+		LPC_TIM2->MR0 = PERIODE_US;
+		//Interruption sur MR0, le compteur tourne librement
+		LPC_TIM2->MCR = 1;
+		NVIC_SetVector(TIMER2_IRQn, (uint32_t)&CapteursPipeline::interruption);
+		NVIC_ClearPendingIRQ(TIMER2_IRQn);
+		NVIC_EnableIRQ(TIMER2_IRQn);
+		//Première charge
+		charge();
+		LPC_TIM2->TCR = 1;
+	}
+
+	//TIMER2 arrêté : son interruption toutes les PERIODE_US empêcherait le sommeil profond
+	//Capteurs laissés en entrée, émetteurs éteints
+	void arrete(){
+		NVIC_DisableIRQ(TIMER2_IRQn);
+		LPC_TIM2->TCR = 0;
+		LPC_TIM2->IR = 0x3F;
+		NVIC_ClearPendingIRQ(TIMER2_IRQn);
+		PortsCapteurs<Liste>::decharge();
+		if(AMBIANT)
+			LPC_GPIO2->FIOCLR = MASQUE_LEDON;
+	}
+
+	bool trame_prete() const { return !trames.vide(); }
+
+	//Copie de la dernière trame complète (attend la prochaine si elle a déjà été lue)
+	//Les trames plus anciennes encore dans la file sont abandonnées
+	EN_RAM void lecture(int temps_us[NB_CAPTEURS]){
+		char i;
+		Trame t;
+		while(!trames.retire_dernier(t));
+		for(i=0; i<NB_CAPTEURS; i++)
+			temps_us[i] = t.temps_us[i];
+	}
+
+	void purge(){
+		Trame t;
+		while(trames.retire(t));
+	}
+
+	//Trames perdues car la boucle principale avait TAILLE_FILE trames de retard
+	unsigned int trames_perdues() const { return perdues; }
+
+	//Réglage de la mesure en cours (télémétrie)
+	int charge_courante_us() const { return gamme.charge_us(); }
+	int fenetre_courante_us() const { return gamme.decharge_max_us(); }
+
+private:
+	enum { CHARGE, DECHARGE };
+	enum {
+		DECHARGE_AMBIANT_MAX_US = 3000,
+		//Trames d'avance possibles sur la boucle principale
+		TAILLE_FILE = 4,
+		//Tous les capteurs
+		TOUS = 0xFFFFFFFFu >> (32 - NB_CAPTEURS),
+		//Broche LEDON des émetteurs sur le port 2
+		MASQUE_LEDON = (1u<<5)
+	};
+
+	//Première partie d'une trame : chargement de la capacité des capteurs
+	//Les émetteurs s'allument ou s'éteignent pendant la charge (réponse en quelques µs)
+	EN_RAM void charge(){
+		if(AMBIANT){
+			ambiante = ++compteur_ambiant >= AMBIANT;
+			if(ambiante){
+				compteur_ambiant = 0;
+				LPC_GPIO2->FIOCLR = MASQUE_LEDON;
+			}
+			else
+				LPC_GPIO2->FIOSET = MASQUE_LEDON;
+		}
+		//Réglage de la trame qui commence
+		essai = gamme.trame_essai();
+		charge_us = gamme.charge_us();
+		fenetre_us = ambiante ? DECHARGE_AMBIANT_MAX_US : gamme.decharge_max_us();
+		PortsCapteurs<Liste>::charge();
+		debut = LPC_TIM2->TC;
+		phase = CHARGE;
+	}
+
+	//Interruption TIMER2 : un échantillon de la trame en cours
+	EN_RAM static void interruption(){
+		instance->echantillonne();
+	}
+
+	EN_RAM void echantillonne(){
+		char i;
+		unsigned int maintenant, duree, prochain;
+		unsigned int niveaux[5], bas, arrives;
+
+		LPC_TIM2->IR = 1;
+		maintenant = LPC_TIM2->TC;
+		//Prochaine interruption (recalée si on a pris du retard)
+		prochain = LPC_TIM2->MR0 + PERIODE_US;
+		if((int)(prochain - maintenant) <= 0)
+			prochain = maintenant + PERIODE_US;
+		LPC_TIM2->MR0 = prochain;
+
+		duree = maintenant - debut;
+		if(phase == CHARGE){
+			//Capacités chargées : capteurs en entrée, début de la décharge
+			if(duree >= charge_us){
+				PortsCapteurs<Liste>::decharge();
+				debut = LPC_TIM2->TC;
+				restants = TOUS;
+				phase = DECHARGE;
+			}
+			return;
+		}
+
+		//Capteurs déchargés (entrée à 0), bit i <=> capteur i+1
+		PortsCapteurs<Liste>::lecture(niveaux);
+		bas = Liste::bas(niveaux);
+		arrives = bas & restants;
+		for(i=0; i<NB_CAPTEURS; i++)
+			if(arrives & (1u<<i))
+				acquisition.temps_us[i] = duree;
+		restants &= ~arrives;
+
+		//Trame ambiante : on garde ses temps pour corriger les suivantes
+		if(ambiante){
+			if(!restants || duree >= fenetre_us){
+				//Capteur pas déchargé : ambiante négligeable, pas de correction
+				for(i=0; i<NB_CAPTEURS; i++)
+					ambiant_us[i] = (restants & (1u<<i)) ? 0 : acquisition.temps_us[i];
+				charge();
+			}
+			return;
+		}
+
+		//Trame terminée : on la publie et on recharge aussitôt pour la suivante
+		if(!restants || duree >= fenetre_us){
+			for(i=0; i<NB_CAPTEURS; i++)
+				if(restants & (1u<<i))
+					acquisition.temps_us[i] = fenetre_us;
+			//Statistiques sur les temps bruts, avant correction de l'ambiante
+			gamme.mesure(acquisition.temps_us);
+			if(AMBIANT)
+				retire_ambiant();
+			if(!essai){
+				if(!trames.ajoute(acquisition))
+					perdues++;
+#if MESURE_LATENCE
+				//Trame prête : la boucle de contrôle peut repartir
+				latence_cycle.evenement();
+#endif
+			}
+			charge();
+		}
+	}
+
+	//Temps de la seule réflexion des émetteurs : t_on*t_off/(t_off - t_on)
+	//t_off <= t_on : les émetteurs n'ajoutent rien (sol noir), temps maximal
+	EN_RAM void retire_ambiant(){
+		char i;
+		unsigned int t_on, t_off, t;
+		for(i=0; i<NB_CAPTEURS; i++){
+			t_on = acquisition.temps_us[i];
+			t_off = ambiant_us[i];
+			if(!t_off)
+				continue;
+			if(t_off <= t_on)
+				t = fenetre_us;
+			else{
+				t = t_on*t_off/(t_off - t_on);
+				if(t > fenetre_us)
+					t = fenetre_us;
+			}
+			acquisition.temps_us[i] = t;
+		}
+	}
+
+	static CapteursPipeline *instance;
+
+	//La liste des broches doit avoir NB_CAPTEURS éléments (erreur de compilation sinon)
+	typedef char nombre_de_broches[Liste::N == NB_CAPTEURS ? 1 : -1];
+
+	//Étape de la trame en cours
+	volatile int phase;
+	//Date (µs) du début de l'étape en cours
+	unsigned int debut;
+	//Capteurs pas encore déchargés
+	unsigned int restants;
+	//Charge et fenêtre de décharge de la trame en cours
+	unsigned int charge_us;
+	unsigned int fenetre_us;
+	//Trame en cours chargée pour un essai de Gamme : pas publiée
+	bool essai;
+	//Réglage de la charge et de la fenêtre
+	Gamme gamme;
+	//Trame en cours d'acquisition
+	Trame acquisition;
+	//Trames complètes, de l'interruption vers la boucle principale
+	FileSPSC<Trame, TAILLE_FILE> trames;
+	//Nombre de trames perdues (file pleine)
+	volatile unsigned int perdues;
+	//Trame en cours mesurée émetteurs éteints
+	bool ambiante;
+	//Trames depuis la dernière trame ambiante
+	int compteur_ambiant;
+	//Temps de décharge dus à la lumière ambiante (0 : négligeable)
+	unsigned int ambiant_us[NB_CAPTEURS];
+};
+
+template<class Liste, int PERIODE_US, int AMBIANT, class Gamme>
+CapteursPipeline<Liste, PERIODE_US, AMBIANT, Gamme> *CapteursPipeline<Liste, PERIODE_US, AMBIANT, Gamme>::instance = 0;
+
+#endif
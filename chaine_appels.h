@@ -0,0 +1,143 @@
+#ifndef CHAINE_APPELS_H
+#define CHAINE_APPELS_H
+
+#include "mbed.h"
+#include "CallChain.h"
+
+//Chaîne de fonctions à capacité fixe, même interface que mbed::CallChain
+//mais sans allocation : les FunctionPointer sont rangés dans un tableau de la classe
+//(CallChain fait un new à chaque add() et agrandit son tableau à l'exécution)
+//Les pointeurs rendus par add()/add_front() restent valables jusqu'au remove()/clear()
+//add() peut être appelé pendant que call() tourne sous interruption ;
+//add_front(), remove() et clear() doivent être faits interruption arrêtée
+//
+//Utilisation avec InterruptIn, Ticker ou Serial :
+//	ChaineAppels<4> chaine;
+//	chaine.add(&objet, &Classe::methode);
+//	boutton.rise(&chaine, &ChaineAppels<4>::call);
+template<int CAPACITE>
+class ChaineAppels {
+public:
+	ChaineAppels() : _elements(0) {
+		int i;
+		for(i=0; i<CAPACITE; i++)
+			_libre[i] = true;
+	}
+
+	//Ajoute une fonction en fin de chaîne (0 si la chaîne est pleine)
+	pFunctionPointer_t add(void (*function)(void)){
+		pFunctionPointer_t pf = reserve();
+		if(pf)
+			pf->attach(function);
+		return insere(pf, _elements);
+	}
+
+	template<typename T>
+	pFunctionPointer_t add(T *tptr, void (T::*mptr)(void)){
+		pFunctionPointer_t pf = reserve();
+		if(pf)
+			pf->attach(tptr, mptr);
+		return insere(pf, _elements);
+	}
+
+	//Ajoute une fonction en début de chaîne (0 si la chaîne est pleine)
+	pFunctionPointer_t add_front(void (*function)(void)){
+		pFunctionPointer_t pf = reserve();
+		if(pf)
+			pf->attach(function);
+		return insere(pf, 0);
+	}
+
+	template<typename T>
+	pFunctionPointer_t add_front(T *tptr, void (T::*mptr)(void)){
+		pFunctionPointer_t pf = reserve();
+		if(pf)
+			pf->attach(tptr, mptr);
+		return insere(pf, 0);
+	}
+
+	int size() const { return _elements; }
+
+	pFunctionPointer_t get(int i) const {
+		if(i < 0 || i >= _elements)
+			return 0;
+		return _chain[i];
+	}
+
+	int find(pFunctionPointer_t f) const {
+		int i;
+		for(i=0; i<_elements; i++)
+			if(_chain[i] == f)
+				return i;
+		return -1;
+	}
+
+	void clear(){
+		int i;
+		_elements = 0;
+		for(i=0; i<CAPACITE; i++)
+			_libre[i] = true;
+	}
+
+	bool remove(pFunctionPointer_t f){
+		int i = find(f);
+		if(i < 0)
+			return false;
+		for(; i<_elements-1; i++)
+			_chain[i] = _chain[i+1];
+		_elements--;
+		_libre[f - _fonctions] = true;
+		return true;
+	}
+
+	//Appelle toutes les fonctions dans l'ordre de la chaîne
+	void call(){
+		int i;
+		for(i=0; i<_elements; i++)
+			_chain[i]->call();
+	}
+
+	void operator ()(void){
+		call();
+	}
+	pFunctionPointer_t operator [](int i) const {
+		return get(i);
+	}
+
+private:
+	//Case libre du tableau de fonctions
+	pFunctionPointer_t reserve(){
+		int i;
+		for(i=0; i<CAPACITE; i++)
+			if(_libre[i]){
+				_libre[i] = false;
+				return &_fonctions[i];
+			}
+		return 0;
+	}
+
+	//Place la fonction à la position donnée de la chaîne
+	pFunctionPointer_t insere(pFunctionPointer_t pf, int position){
+		int i;
+		if(!pf)
+			return 0;
+		for(i=_elements; i>position; i--)
+			_chain[i] = _chain[i-1];
+		_chain[position] = pf;
+		//La fonction est en place avant d'être visible pour call()
+		__DMB();
+		_elements++;
+		return pf;
+	}
+
+	FunctionPointer _fonctions[CAPACITE];
+	bool _libre[CAPACITE];
+	pFunctionPointer_t _chain[CAPACITE];
+	volatile int _elements;
+
+	/* disallow copy constructor and assignment operators */
+	ChaineAppels(const ChaineAppels&);
+	ChaineAppels & operator = (const ChaineAppels&);
+};
+
+#endif
@@ -0,0 +1,41 @@
+#ifndef CODEURS_H
+#define CODEURS_H
+
+#include "mbed.h"
+#include "identification.h"
+
+//Codeurs optionnels sur les roues (CODEURS_ROUES), pour l'identification des moteurs
+//Une voie par roue : les fronts montants sont comptés sous interruption, sans le sens
+//de rotation (les moteurs ne tournent qu'en marche avant)
+#define BROCHE_CODEUR_DROIT p27
+#define BROCHE_CODEUR_GAUCHE p28
+
+class CodeursRoues {
+public:
+	CodeursRoues() : voie_droite(BROCHE_CODEUR_DROIT), voie_gauche(BROCHE_CODEUR_GAUCHE), fronts_droite(0), fronts_gauche(0) {}
+
+	void demarre(){
+		voie_droite.rise(this, &CodeursRoues::front_droite);
+		voie_gauche.rise(this, &CodeursRoues::front_gauche);
+	}
+
+	//Fronts comptés depuis le démarrage, en Q8 comme les positions de la ligne
+	int position(int moteur) const {
+		return (moteur == MOTEUR_DROIT ? fronts_droite : fronts_gauche) << 8;
+	}
+
+private:
+	void front_droite(){
+		fronts_droite++;
+	}
+	void front_gauche(){
+		fronts_gauche++;
+	}
+
+	InterruptIn voie_droite;
+	InterruptIn voie_gauche;
+	volatile int fronts_droite;
+	volatile int fronts_gauche;
+};
+
+#endif
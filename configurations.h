@@ -0,0 +1,64 @@
+#ifndef CONFIGURATIONS_H
+#define CONFIGURATIONS_H
+
+#include "filtre.h"
+#include "decision.h"
+#include "seuil.h"
+#include "pilotage.h"
+
+//Étapes de calcul de chaque configuration du robot
+//(partagées avec l'outil de rejeu : aucun type dépendant du matériel ici)
+
+#if NB_CAPTEURS == 6
+//1 -> règles souples, vitesses lentes, seuil fixe (ancien main1.cpp)
+struct ConfigControle1 {
+	typedef FiltreAucun Filtre;
+	typedef DecisionSouple Decision;
+	typedef PilotageTable<VitessesConfig1> Pilotage;
+	typedef SeuilFixe Seuil;
+};
+
+//2 -> règles strictes, vitesses rapides, seuil du calibrage (ancien main2.cpp)
+struct ConfigControle2 {
+	typedef FiltreAucun Filtre;
+	typedef DecisionStricte Decision;
+	typedef PilotageTable<VitessesConfig2> Pilotage;
+	typedef SeuilFixe Seuil;
+};
+
+//6 -> comme 2, avec médiane sur 3 lectures et suivi des niveaux noir/blanc
+struct ConfigControle6 {
+	typedef FiltreMedian<3> Filtre;
+	typedef DecisionStricte Decision;
+	typedef PilotageTable<VitessesConfig2> Pilotage;
+	typedef SeuilAdaptatif<5> Seuil;
+};
+#endif
+
+//3 -> comme 6, mais décision par groupes de capteurs : barrette de NB_CAPTEURS quelconque
+struct ConfigControle3 {
+	typedef FiltreMedian<3> Filtre;
+	typedef DecisionSegments Decision;
+	typedef PilotageTable<VitessesConfig2> Pilotage;
+	typedef SeuilAdaptatif<5> Seuil;
+};
+
+//4 -> commande continue : position de la ligne estimée (filtre de Kalman) et
+//     correcteur proportionnel-dérivé avec anticipation des virages,
+//     pour une barrette de NB_CAPTEURS quelconque
+struct ConfigControle4 {
+	typedef FiltreMedian<3> Filtre;
+	typedef DecisionSegments Decision;
+	typedef PilotagePD<700, 250, 3000, 100> Pilotage;
+	typedef SeuilAdaptatif<5> Seuil;
+};
+
+//5 -> comme 3, avec l'écart entre moteurs anticipé à partir de la courbure estimée
+struct ConfigControle5 {
+	typedef FiltreMedian<3> Filtre;
+	typedef DecisionSegments Decision;
+	typedef PilotageTable<VitessesConfig2, 100> Pilotage;
+	typedef SeuilAdaptatif<5> Seuil;
+};
+
+#endif
@@ -0,0 +1,58 @@
+#ifndef CONTROLE_H
+#define CONTROLE_H
+
+#include "filtre.h"
+#include "decision.h"
+#include "seuil.h"
+#include "pilotage.h"
+#include "memoire.h"
+
+//Partie calcul d'un cycle de contrôle, sans aucun accès au matériel :
+//filtrage -> décision (set_direction) -> vitesses (pilotage) -> suivi des seuils
+//Le même code tourne dans le robot et dans l'outil de rejeu sur PC (outils/rejeu.cpp)
+//Config fournit les types Filtre, Decision, Pilotage et Seuil
+template<class Config>
+class Controle {
+public:
+	//Seuils de départ donnés par le calibrage
+	template<class Calibrage>
+	void init(const Calibrage &calibrage){
+		seuil_.init(calibrage);
+	}
+
+	//Un cycle complet à partir des temps bruts (remplacés par les temps filtrés)
+	EN_RAM int cycle(int temps_us[NB_CAPTEURS]){
+		filtre(temps_us);
+		return decide(temps_us);
+	}
+
+	//Les deux étapes du cycle, séparées pour mesurer la durée du filtre (MESURE_CYCLES)
+	//On filtre les lectures aberrantes
+	EN_RAM void filtre(int temps_us[NB_CAPTEURS]){
+		filtre_.filtre(temps_us);
+	}
+
+	//Décision, vitesses et seuils à partir des temps filtrés
+	EN_RAM int decide(const int temps_us[NB_CAPTEURS]){
+		int dir = decision_.set_direction(temps_us, seuil_.seuils());
+		//Vitesses des moteurs (avec les seuils de la décision)
+		pilotage_.calcule(decision_, temps_us, seuil_.seuils());
+		//Suivi des niveaux noir/blanc à partir de la décision
+		seuil_.adapte(temps_us, decision_.masque(), decision_.confiance());
+		return dir;
+	}
+
+	const typename Config::Decision &decision() const { return decision_; }
+	const typename Config::Seuil &seuil() const { return seuil_; }
+	const typename Config::Pilotage &pilotage() const { return pilotage_; }
+	//Réglage du pilotage (gains, essai de réglage)
+	typename Config::Pilotage &pilotage(){ return pilotage_; }
+
+private:
+	typename Config::Filtre filtre_;
+	typename Config::Decision decision_;
+	typename Config::Seuil seuil_;
+	typename Config::Pilotage pilotage_;
+};
+
+#endif
@@ -0,0 +1,249 @@
+#ifndef DECISION_H
+#define DECISION_H
+
+#include "parametres.h"
+#include "memoire.h"
+
+//Stratégies de décision : choix de la direction à partir des temps de descente
+//Direction négative -> vers la gauche
+//Direction positive -> vers la droite
+//Un capteur est sur la ligne blanche lorsque son temps est inférieur à son seuil
+
+//Les capteurs sont regroupés en un masque de NB_CAPTEURS bits (bit i <=> capteur i+1 sur la ligne)
+//Jusqu'à 8 capteurs la décision est lue dans une table générée à la compilation
+//à partir de règles déclaratives : une seule lecture par cycle, quel que soit le motif
+//Au-delà (table trop grosse), DecisionSegments cherche les groupes de capteurs sur la ligne
+
+//Niveaux de confiance associés à une décision
+enum {
+	CONFIANCE_NULLE = 0,	//aucune règle : on garde la dernière direction
+	CONFIANCE_FAIBLE = 1,	//règle reconnue mais motif "sale" (capteurs en trop)
+	CONFIANCE_FORTE = 2	//ligne vue par 1 capteur ou 2 capteurs voisins
+};
+
+//Entrée de la table de décision
+struct Commande {
+	signed char direction;
+	unsigned char confiance;
+};
+
+//Masque des capteurs sur la ligne blanche
+//(boucle de longueur fixe : déroulée par le compilateur, sans branchement)
+inline int masque_capteurs(const int temps_us[NB_CAPTEURS], const int seuils[NB_CAPTEURS]){
+	int masque = 0;
+	char i;
+	for(i=0; i<NB_CAPTEURS; i++)
+		masque |= (temps_us[i] < seuils[i]) << i;
+	return masque;
+}
+
+//Motif "propre" : un capteur seul ou deux capteurs voisins sur la ligne
+template<int M>
+struct MotifPropre {
+	enum { valeur = M != 0 && ((M & (M-1)) == 0 || M == (M & -M)*3) };
+};
+
+//Fin d'une liste de règles : aucun motif reconnu
+struct FinRegles {
+	template<int M>
+	struct Applique {
+		enum { trouve = 0, direction = 0 };
+	};
+};
+
+//Règle : si (masque & Masque) == Valeur alors direction = Dir, sinon on essaie la Suite
+//La première règle vérifiée l'emporte, comme dans une suite de if/else if
+template<int Masque, int Valeur, int Dir, class Suite = FinRegles>
+struct Regle {
+	template<int M>
+	struct Applique {
+		enum {
+			trouve = (M & Masque) == Valeur ? 1 : (int)Suite::template Applique<M>::trouve,
+			direction = (M & Masque) == Valeur ? Dir : (int)Suite::template Applique<M>::direction
+		};
+	};
+};
+
+//Règles de l'ancien main1.cpp (6 capteurs) : seuls les capteurs voisins sont testés
+typedef
+	//les 2 capteurs du centre sur la ligne blanche -> avancer tout droit
+	Regle<0x0C, 0x0C,  0,
+	//3ème capteur sur la ligne, pas le 2ème -> tourner legerement vers la gauche
+	Regle<0x06, 0x04, -1,
+	//2ème capteur sur la ligne, pas le 3ème -> tourner moyennement vers la gauche
+	Regle<0x06, 0x02, -2,
+	//1er capteur sur la ligne, pas le 2ème -> tourner fortement vers la gauche
+	Regle<0x03, 0x01, -3,
+	//4ème capteur sur la ligne, pas le 3ème -> tourner legerement vers la droite
+	Regle<0x0C, 0x08,  1,
+	//5ème capteur sur la ligne, pas le 4ème -> tourner moyennement vers la droite
+	Regle<0x18, 0x10,  2,
+	//6ème capteur sur la ligne, pas le 5ème -> tourner fortement vers la droite
+	Regle<0x30, 0x20,  3
+	> > > > > > > ReglesSouples;
+
+//Règles de l'ancien main2.cpp (6 capteurs) : un seul motif exact des 6 capteurs par direction
+typedef
+	//les 2 capteurs du centre sont sur la ligne blanche -> avancer tout droit
+	Regle<0x3F, 0x0C,  0,
+	//le 3ème capteur est le seul sur la ligne blanche -> tourner legerement vers la gauche
+	Regle<0x3F, 0x04, -1,
+	//le 2ème capteur est le seul sur la ligne blanche -> tourner moyennement vers la gauche
+	Regle<0x3F, 0x02, -2,
+	//le 1er capteur est le seul sur la ligne blanche -> tourner fortement vers la gauche
+	Regle<0x3F, 0x01, -3,
+	//le 4ème capteur est le seul sur la ligne blanche -> tourner legerement vers la droite
+	Regle<0x3F, 0x08,  1,
+	//le 5ème capteur est le seul sur la ligne blanche -> tourner moyennement vers la droite
+	Regle<0x3F, 0x10,  2,
+	//le 6ème capteur est le seul sur la ligne blanche -> tourner fortement vers la droite
+	Regle<0x3F, 0x20,  3
+	> > > > > > > ReglesStrictes;
+
+#if NB_CAPTEURS <= 8
+//Table des 2^NB_CAPTEURS motifs générée à la compilation à partir des règles
+//(initialisation constante : la table est placée en flash)
+//64 entrées jusqu'à 6 capteurs, 256 pour 7 ou 8
+#if NB_CAPTEURS <= 6
+#define TAILLE_TABLE_DECISION 64
+#else
+#define TAILLE_TABLE_DECISION 256
+#endif
+
+template<class Regles>
+struct TableDecision {
+	static const Commande table[TAILLE_TABLE_DECISION];
+};
+
+#define ENTREE_DECISION(M) { \
+	(signed char)Regles::template Applique<M>::direction, \
+	(unsigned char)(!Regles::template Applique<M>::trouve ? CONFIANCE_NULLE : \
+		MotifPropre<M>::valeur ? CONFIANCE_FORTE : CONFIANCE_FAIBLE) }
+#define ENTREES_DECISION_8(M) \
+	ENTREE_DECISION(M),   ENTREE_DECISION(M+1), ENTREE_DECISION(M+2), ENTREE_DECISION(M+3), \
+	ENTREE_DECISION(M+4), ENTREE_DECISION(M+5), ENTREE_DECISION(M+6), ENTREE_DECISION(M+7)
+
+#define ENTREES_DECISION_64(M) \
+	ENTREES_DECISION_8(M),    ENTREES_DECISION_8(M+8),  ENTREES_DECISION_8(M+16), ENTREES_DECISION_8(M+24), \
+	ENTREES_DECISION_8(M+32), ENTREES_DECISION_8(M+40), ENTREES_DECISION_8(M+48), ENTREES_DECISION_8(M+56)
+
+template<class Regles>
+const Commande TableDecision<Regles>::table[TAILLE_TABLE_DECISION] = {
+#if TAILLE_TABLE_DECISION == 64
+	ENTREES_DECISION_64(0)
+#else
+	ENTREES_DECISION_64(0), ENTREES_DECISION_64(64), ENTREES_DECISION_64(128), ENTREES_DECISION_64(192)
+#endif
+};
+
+#undef ENTREES_DECISION_64
+#undef ENTREES_DECISION_8
+#undef ENTREE_DECISION
+
+//Décision par lecture dans la table générée à partir de Regles
+template<class Regles>
+class DecisionTable {
+public:
+	DecisionTable() : direction(0), masque_(0), confiance_(CONFIANCE_NULLE) {}
+
+	//Règle la direction à prendre par le robot
+	EN_RAM int set_direction(const int temps_us[NB_CAPTEURS], const int seuils[NB_CAPTEURS]){
+		masque_ = masque_capteurs(temps_us, seuils);
+		const Commande &c = TableDecision<Regles>::table[masque_];
+		confiance_ = c.confiance;
+		//lorsqu'aucune règle ne s'applique (tout noir...) -> suivre la derniere direction
+		if(c.confiance != CONFIANCE_NULLE)
+			direction = c.direction;
+		//on renvoie la direction choisie
+		return direction;
+	}
+
+	//Dernière direction choisie
+	int direction_courante() const { return direction; }
+	//Masque des capteurs sur la ligne lors de la dernière décision
+	int masque() const { return masque_; }
+	//Confiance de la dernière décision
+	int confiance() const { return confiance_; }
+
+private:
+	//Dernière direction choisie
+	int direction;
+	//Masque de la dernière décision
+	int masque_;
+	//Confiance de la dernière décision
+	int confiance_;
+};
+
+typedef DecisionTable<ReglesSouples> DecisionSouple;
+typedef DecisionTable<ReglesStrictes> DecisionStricte;
+#endif
+
+//Décision par recherche des groupes de capteurs voisins sur la ligne,
+//pour un nombre quelconque de capteurs (pas de table)
+//un seul groupe de 1 ou 2 capteurs        -> CONFIANCE_FORTE
+//plusieurs groupes ou groupe plus large   -> CONFIANCE_FAIBLE, on suit le groupe
+//                                            le plus proche de la dernière position
+//aucun capteur sur la ligne               -> CONFIANCE_NULLE, dernière direction
+//La direction est le centre du groupe ramené de [capteur 1, capteur NB_CAPTEURS] à [-3, 3]
+//(avec 6 capteurs : mêmes directions que ReglesStrictes pour un capteur seul)
+class DecisionSegments {
+public:
+	DecisionSegments() : direction(0), position(NB_CAPTEURS-1), masque_(0), confiance_(CONFIANCE_NULLE) {}
+
+	//Règle la direction à prendre par le robot
+	EN_RAM int set_direction(const int temps_us[NB_CAPTEURS], const int seuils[NB_CAPTEURS]){
+		char i;
+		int debut = 0, groupes = 0, largeur = 0, choisi = -1, ecart_choisi = 0;
+		masque_ = masque_capteurs(temps_us, seuils);
+		//Un groupe commence sur un capteur de la ligne après un capteur hors de la ligne
+		//et se termine au capteur hors de la ligne suivant (ou après le dernier capteur)
+		for(i=0; i<=NB_CAPTEURS; i++){
+			bool sur_ligne = i < NB_CAPTEURS && (masque_ >> i & 1);
+			bool precedent = i > 0 && (masque_ >> (i-1) & 1);
+			if(sur_ligne && !precedent)
+				debut = i;
+			else if(!sur_ligne && precedent){
+				//Centre du groupe en demi-capteurs : debut + fin
+				int centre = debut + i - 1;
+				int ecart = centre > position ? centre - position : position - centre;
+				if(choisi < 0 || ecart < ecart_choisi){
+					choisi = centre;
+					ecart_choisi = ecart;
+					largeur = i - debut;
+				}
+				groupes++;
+			}
+		}
+		if(!groupes){
+			confiance_ = CONFIANCE_NULLE;
+			return direction;
+		}
+		confiance_ = (groupes == 1 && largeur <= 2) ? CONFIANCE_FORTE : CONFIANCE_FAIBLE;
+		position = choisi;
+		direction = vers_direction(choisi);
+		return direction;
+	}
+
+	int direction_courante() const { return direction; }
+	int masque() const { return masque_; }
+	int confiance() const { return confiance_; }
+
+private:
+	//Centre (demi-capteurs, 0 à 2*(NB_CAPTEURS-1)) -> direction de -3 à 3, arrondie
+	static int vers_direction(int centre){
+		int n = 3*(centre - (NB_CAPTEURS-1));
+		int d = NB_CAPTEURS-1;
+		return (n + (n >= 0 ? d/2 : -d/2)) / d;
+	}
+
+	//Dernière direction choisie
+	int direction;
+	//Centre du dernier groupe suivi (demi-capteurs)
+	int position;
+	//Masque de la dernière décision
+	int masque_;
+	//Confiance de la dernière décision
+	int confiance_;
+};
+
+#endif
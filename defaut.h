@@ -0,0 +1,102 @@
+#ifndef DEFAUT_H
+#define DEFAUT_H
+
+#include "mbed.h"
+#include "boite_noire.h"
+
+//Capture des défauts matériels (HardFault, MemManage, BusFault, UsageFault) pour le
+//démarrage suivant : registres empilés par l'exception (PC et LR du code fautif),
+//registres d'état du défaut, nombre de cycles de course et dernier cycle de contrôle
+//L'enregistrement est dans la région RW_NOINIT de LPC1768.sct (UNINIT : ni copiée ni
+//mise à zéro au démarrage) : il survit au redémarrage qui suit le vidage de la boîte
+//noire, et il est envoyé sur la liaison série au démarrage suivant puis effacé
+//Une marque et une somme de contrôle écartent le contenu aléatoire de la RAM à la mise sous tension
+
+#define MAGIE_DEFAUT 0x44465431u	//"DFT1"
+
+//Exceptions capturées (numéro lu dans IPSR)
+enum {
+	EXCEPTION_HARDFAULT = 3,
+	EXCEPTION_MEMMANAGE = 4,
+	EXCEPTION_BUSFAULT = 5,
+	EXCEPTION_USAGEFAULT = 6
+};
+
+//Registres empilés par le processeur à l'entrée de l'exception
+enum {
+	CADRE_R0, CADRE_R1, CADRE_R2, CADRE_R3, CADRE_R12, CADRE_LR, CADRE_PC, CADRE_XPSR,
+	TAILLE_CADRE
+};
+
+struct EnregistrementDefaut {
+	unsigned int magie;
+	unsigned int exception;
+	//Cadre empilé (à 0 si la pile fautive était hors de la RAM)
+	unsigned int cadre[TAILLE_CADRE];
+	//EXC_RETURN (pile MSP ou PSP du code fautif) et pointeur de pile au moment du défaut
+	unsigned int exc_return;
+	unsigned int sp;
+	//Causes : CFSR (MemManage, BusFault, UsageFault), HFSR, adresses fautives
+	unsigned int cfsr;
+	unsigned int hfsr;
+	unsigned int mmfar;
+	unsigned int bfar;
+	//Cycles de course depuis le démarrage, date du défaut (horloge.h)
+	unsigned int cycles;
+	unsigned int date_ms;
+	//Dernier cycle enregistré dans la boîte noire (valide si nombre_cycles > 0)
+	unsigned int nombre_cycles;
+	Enregistrement dernier;
+	unsigned int controle;
+};
+
+inline unsigned int controle_defaut(const EnregistrementDefaut &d){
+	const unsigned int *mots = (const unsigned int *)&d;
+	unsigned int somme = 0x5A5A5A5Au, i;
+	for(i=0; i<(unsigned int)((const unsigned int *)&d.controle - mots); i++)
+		somme = (somme << 1 | somme >> 31) ^ mots[i];
+	return somme;
+}
+
+inline bool defaut_valide(const EnregistrementDefaut &d){
+	return d.magie == MAGIE_DEFAUT && d.controle == controle_defaut(d);
+}
+
+//Pile dans la RAM locale ou les banques AHB : le cadre peut être lu sans nouveau défaut
+inline bool pile_lisible(unsigned int sp){
+	return (sp & 3) == 0 && ((sp >= 0x10000000u && sp <= 0x10008000u - 4*TAILLE_CADRE)
+		|| (sp >= 0x2007C000u && sp <= 0x20084000u - 4*TAILLE_CADRE));
+}
+
+//Partie processeur de l'enregistrement, dans le gestionnaire de défaut
+inline void capture_processeur(EnregistrementDefaut &d, const unsigned int *cadre, unsigned int exc_return){
+	int i;
+	d.magie = MAGIE_DEFAUT;
+	d.exception = __get_IPSR() & 0x1FF;
+	d.exc_return = exc_return;
+	d.sp = (unsigned int)cadre;
+	for(i=0; i<TAILLE_CADRE; i++)
+		d.cadre[i] = pile_lisible(d.sp) ? cadre[i] : 0;
+	d.cfsr = SCB->CFSR;
+	d.hfsr = SCB->HFSR;
+	d.mmfar = SCB->MMFAR;
+	d.bfar = SCB->BFAR;
+}
+
+//Envoi sur la liaison série au démarrage (écriture bloquante, avant la télémétrie)
+inline void rapporte_defaut(Serial &port, const EnregistrementDefaut &d){
+	static const char *noms[] = {"HardFault", "MemManage", "BusFault", "UsageFault"};
+	const char *nom = d.exception >= EXCEPTION_HARDFAULT && d.exception <= EXCEPTION_USAGEFAULT ?
+		noms[d.exception - EXCEPTION_HARDFAULT] : "exception inconnue";
+	port.printf("\r\nDEFAUT precedent : %s a %u ms, apres %u cycles de course\r\n", nom, d.date_ms, d.cycles);
+	port.printf("  PC %08X  LR %08X  xPSR %08X  SP %08X (%s)\r\n", d.cadre[CADRE_PC], d.cadre[CADRE_LR],
+		d.cadre[CADRE_XPSR], d.sp, (d.exc_return & 4) ? "PSP" : "MSP");
+	port.printf("  R0 %08X  R1 %08X  R2 %08X  R3 %08X  R12 %08X\r\n", d.cadre[CADRE_R0], d.cadre[CADRE_R1],
+		d.cadre[CADRE_R2], d.cadre[CADRE_R3], d.cadre[CADRE_R12]);
+	port.printf("  CFSR %08X  HFSR %08X  MMFAR %08X  BFAR %08X\r\n", d.cfsr, d.hfsr, d.mmfar, d.bfar);
+	if(d.nombre_cycles)
+		port.printf("  dernier cycle : date %u us, direction %d, confiance %u, vitesses %u %u\r\n",
+			d.dernier.date_us, d.dernier.direction, d.dernier.confiance, d.dernier.droite, d.dernier.gauche);
+}
+
+#endif
@@ -0,0 +1,139 @@
+#ifndef ESTIMATION_H
+#define ESTIMATION_H
+
+#include "parametres.h"
+#include "virgule_fixe.h"
+#include "memoire.h"
+
+//Estimation de la position de la ligne sous la barrette, en virgule fixe
+//Unités : pas de capteur (distance entre deux capteurs voisins), par cycle de contrôle
+//Position 0 : ligne au centre de la barrette, négative vers le capteur 1 (gauche)
+
+//Position mesurée : barycentre des capteurs sur la ligne, pondérés par leur écart
+//au seuil (un capteur bien blanc compte plus qu'un capteur à la limite), en Q8
+//Renvoie false si aucun capteur n'est sous son seuil
+EN_RAM inline bool position_ligne(const int temps_us[NB_CAPTEURS], const int seuils[NB_CAPTEURS], int &position_q8){
+	int somme = 0, moment = 0, poids;
+	char i;
+	for(i=0; i<NB_CAPTEURS; i++){
+		poids = seuils[i] - temps_us[i];
+		if(poids > 0){
+			somme += poids;
+			//Capteur i à (i - (NB_CAPTEURS-1)/2) pas du centre, en demi-pas*128 = Q8
+			moment += poids * ((2*i - (NB_CAPTEURS-1)) * 128);
+		}
+	}
+	if(!somme)
+		return false;
+	position_q8 = moment / somme;
+	return true;
+}
+
+//Réglage de l'estimateur pour la barrette de 6 capteurs et un cycle de 2ms
+//Gains permanents donnés par outils/gains_kalman.cpp (bruits 0.3 0.02 0.002 0.0002)
+//Effet de la commande : vitesse 0.5 m/s, 1 m/s d'écart entre roues à 1000‰,
+//voie de 15 cm, barrette à 10 cm devant l'essieu, pas de 9.5 mm
+struct ReglageEstimateur {
+	enum {
+		//Gains de Kalman en Q16
+		GAIN_POSITION = 11835,
+		GAIN_CAP = 1065,
+		GAIN_COURBURE = 40,
+		//Effet d'un ‰ de commande différentielle (droite - gauche) pendant un cycle, Q24 :
+		//rotation de la barrette autour de l'essieu (position) et changement de cap
+		EFFET_POSITION = 2350,
+		EFFET_CAP = 23
+	};
+};
+
+//Filtre de Kalman à gains permanents sur 3 états, en Q24 :
+//position -> écart latéral de la ligne
+//cap      -> dérive de la position par cycle due à l'angle du robot avec la ligne
+//courbure -> variation du cap par cycle non expliquée par la commande (virage de la piste)
+//Modèle : position' = position + cap + EFFET_POSITION*commande
+//         cap'      = cap + courbure + EFFET_CAP*commande
+//Sans mesure (ligne perdue) seule la prédiction est faite : l'estimation continue
+//la trajectoire, bornée à un pas au-delà du bord de la barrette (cap et courbure
+//repartent alors de zéro)
+template<class Reglage>
+class EstimateurLigne {
+public:
+	EstimateurLigne() : position_(0), cap_(0), courbure_(0), commande_(0), initialise(false), sans_mesure(0) {}
+
+	//Un cycle : prédiction avec la commande appliquée au cycle précédent, puis correction
+	//commande : droite - gauche en ‰
+	EN_RAM void cycle(bool mesure_valide, int mesure_q8, int commande){
+		predit();
+		commande_ = commande;
+		if(!mesure_valide){
+			sans_mesure++;
+			return;
+		}
+		sans_mesure = 0;
+		//Première mesure : on part de la position vue, robot supposé aligné
+		if(!initialise){
+			position_ = mesure_q8 << (FRACTION - 8);
+			cap_ = courbure_ = 0;
+			initialise = true;
+			return;
+		}
+		//Innovation en Q8, gains Q16 : corrections directement en Q24
+		int innovation = mesure_q8 - (position_ >> (FRACTION - 8));
+		position_ += Reglage::GAIN_POSITION * innovation;
+		cap_ += Reglage::GAIN_CAP * innovation;
+		courbure_ = sature<FRACTION - 5>(courbure_ + Reglage::GAIN_COURBURE * innovation);
+	}
+
+	//Écart latéral et sa vitesse (pas, pas/cycle, Q24)
+	int position() const { return position_; }
+	int vitesse_position() const { return cap_ + Reglage::EFFET_POSITION * commande_; }
+	//Cap (dérive par cycle, proportionnelle à l'angle à vitesse constante) et sa vitesse
+	int cap() const { return cap_; }
+	int vitesse_cap() const { return courbure_ + Reglage::EFFET_CAP * commande_; }
+	//Courbure de la piste vue depuis le robot
+	int courbure() const { return courbure_; }
+	//Commande différentielle (‰) qui fait tourner le robot comme la piste :
+	//dans un virage de rayon constant, cap et position restent alors fixes
+	int commande_virage() const { return -courbure_ / Reglage::EFFET_CAP; }
+	//Cycles consécutifs sans voir la ligne
+	int cycles_sans_mesure() const { return sans_mesure; }
+
+	enum {
+		FRACTION = 24,
+		//Borne de la position : un pas au-delà du capteur du bord
+		LIMITE = ((NB_CAPTEURS + 1) << FRACTION) / 2,
+		//Borne du cap : un pas par cycle (saturation sur FRACTION+1 bits)
+		CAP_MAX = 1 << FRACTION,
+		//Borne de la courbure : 1/64 pas par cycle², le cap passe de 0 à CAP_MAX en
+		//64 cycles (saturation sur FRACTION-5 bits) ; au-delà de ce que donne la mesure en
+		//course, commande_virage() reste bornée sur des mesures aberrantes
+		COURBURE_MAX = 1 << (FRACTION - 6)
+	};
+
+private:
+	void predit(){
+		if(!initialise)
+			return;
+		position_ += cap_ + Reglage::EFFET_POSITION * commande_;
+		cap_ += courbure_ + Reglage::EFFET_CAP * commande_;
+		cap_ = sature<FRACTION + 1>(cap_);
+		if(position_ > LIMITE){
+			position_ = LIMITE;
+			cap_ = courbure_ = 0;
+		}
+		else if(position_ < -LIMITE){
+			position_ = -LIMITE;
+			cap_ = courbure_ = 0;
+		}
+	}
+
+	int position_;
+	int cap_;
+	int courbure_;
+	//Commande appliquée depuis la dernière mesure
+	int commande_;
+	bool initialise;
+	int sans_mesure;
+};
+
+#endif
@@ -0,0 +1,73 @@
+#ifndef FIFO_H
+#define FIFO_H
+
+//File circulaire sans verrou à un producteur et un consommateur (SPSC)
+//Typiquement : une interruption produit, la boucle principale consomme (ou l'inverse)
+//Aucune interruption n'est masquée : chaque indice n'est écrit que par un seul côté
+//ecriture -> modifié uniquement par le producteur (ajoute)
+//lecture  -> modifié uniquement par le consommateur (retire)
+//Les indices tournent librement, TAILLE (puissance de 2) sert de masque
+//Utilisable sur PC (threads) pour la mise au point : seule la barrière change
+
+#if defined(__CC_ARM) || defined(TARGET_LPC1768)
+#include "cmsis.h"
+//Barrière mémoire Cortex-M3 (core_cmInstr.h), empêche aussi le compilateur de réordonner
+#define BARRIERE_FIFO() __DMB()
+#else
+#define BARRIERE_FIFO() __sync_synchronize()
+#endif
+
+template<class T, int TAILLE>
+class FileSPSC {
+public:
+	FileSPSC() : ecriture(0), lecture(0) {}
+
+	//Côté producteur : false si la file est pleine (l'élément est perdu)
+	bool ajoute(const T &element){
+		unsigned int e = ecriture;
+		if(e - lecture == TAILLE)
+			return false;
+		elements[e & (TAILLE-1)] = element;
+		//L'élément est écrit avant d'être rendu visible au consommateur
+		BARRIERE_FIFO();
+		ecriture = e + 1;
+		return true;
+	}
+
+	//Côté consommateur : false si la file est vide
+	bool retire(T &element){
+		unsigned int l = lecture;
+		if(ecriture == l)
+			return false;
+		//L'indice est lu avant l'élément
+		BARRIERE_FIFO();
+		element = elements[l & (TAILLE-1)];
+		//L'élément est copié avant que sa case soit rendue au producteur
+		BARRIERE_FIFO();
+		lecture = l + 1;
+		return true;
+	}
+
+	//Côté consommateur : ne garde que l'élément le plus récent
+	bool retire_dernier(T &element){
+		bool trouve = false;
+		while(retire(element))
+			trouve = true;
+		return trouve;
+	}
+
+	//Valeurs indicatives si l'autre côté travaille en même temps
+	bool vide() const { return ecriture == lecture; }
+	bool pleine() const { return ecriture - lecture == TAILLE; }
+	int nombre() const { return ecriture - lecture; }
+
+private:
+	//TAILLE doit être une puissance de 2 (erreur de compilation sinon)
+	typedef char taille_puissance_de_2[(TAILLE > 0 && (TAILLE & (TAILLE-1)) == 0) ? 1 : -1];
+
+	T elements[TAILLE];
+	volatile unsigned int ecriture;
+	volatile unsigned int lecture;
+};
+
+#endif
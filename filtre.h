@@ -0,0 +1,121 @@
+#ifndef FILTRE_H
+#define FILTRE_H
+
+#include "parametres.h"
+#include "memoire.h"
+
+//Stratégies de filtrage des temps de descente, entre l'acquisition et la décision
+//Calculs entiers uniquement (pas de FPU sur le Cortex-M3), sans branchement
+//dépendant des données : durée constante à chaque cycle
+//filtre() remplace les temps bruts par les temps filtrés
+
+//Minimum et maximum sans branchement (compilés en comparaison + exécution conditionnelle)
+inline int min_filtre(int a, int b){ return a < b ? a : b; }
+inline int max_filtre(int a, int b){ return a < b ? b : a; }
+
+//Pas de filtrage : les temps bruts passent directement à la décision
+class FiltreAucun {
+public:
+	void filtre(int temps_us[NB_CAPTEURS]){}
+};
+
+//Médiane glissante sur N lectures (N = 3 ou 5) pour chaque capteur
+//Élimine une lecture aberrante isolée (N=3) ou deux (N=5)
+//Retard introduit : (N-1)/2 cycles
+template<int N>
+class FiltreMedian {
+public:
+	FiltreMedian() : position(0), premier(true) {}
+
+	EN_RAM void filtre(int temps_us[NB_CAPTEURS]){
+		char i, j;
+		//Au premier cycle l'historique est rempli avec la première lecture
+		if(premier){
+			for(i=0; i<NB_CAPTEURS; i++)
+				for(j=0; j<N; j++)
+					historique[i][j] = temps_us[i];
+			premier = false;
+		}
+		for(i=0; i<NB_CAPTEURS; i++){
+			historique[i][position] = temps_us[i];
+			temps_us[i] = mediane(historique[i]);
+		}
+		position = (position + 1 == N) ? 0 : position + 1;
+	}
+
+private:
+	static int mediane(const int *h);
+
+	//Dernières lectures de chaque capteur
+	int historique[NB_CAPTEURS][N];
+	//Case de l'historique à remplacer au prochain cycle
+	int position;
+	//Historique vide
+	bool premier;
+};
+
+//Médiane de 3 : 4 min/max
+template<>
+inline int FiltreMedian<3>::mediane(const int *h){
+	return max_filtre(min_filtre(h[0], h[1]), min_filtre(max_filtre(h[0], h[1]), h[2]));
+}
+
+//Médiane de 5 : réseau de 7 comparaisons/échanges
+template<>
+inline int FiltreMedian<5>::mediane(const int *h){
+	int a = h[0], b = h[1], c = h[2], d = h[3], e = h[4], t;
+	//On écarte le plus petit et le plus grand de chaque paire...
+	t = min_filtre(a, b); b = max_filtre(a, b); a = t;
+	t = min_filtre(d, e); e = max_filtre(d, e); d = t;
+	//...puis le minimum et le maximum globaux parmi a, b, d, e
+	t = max_filtre(a, d);
+	b = min_filtre(b, e);
+	//La médiane des 5 est la médiane de {t, b, c}
+	return max_filtre(min_filtre(t, b), min_filtre(max_filtre(t, b), c));
+}
+
+//Lissage exponentiel (filtre IIR du 1er ordre) : y += (x - y) / 2^DECALAGE
+//État en virgule fixe avec 4 bits de fraction pour ne pas perdre les petites variations
+//Constante de temps ≈ 2^DECALAGE cycles
+template<int DECALAGE>
+class FiltreIIR {
+public:
+	FiltreIIR() : premier(true) {}
+
+	EN_RAM void filtre(int temps_us[NB_CAPTEURS]){
+		char i;
+		if(premier){
+			for(i=0; i<NB_CAPTEURS; i++)
+				etat[i] = temps_us[i] << FRACTION;
+			premier = false;
+		}
+		for(i=0; i<NB_CAPTEURS; i++){
+			etat[i] += ((temps_us[i] << FRACTION) - etat[i]) >> DECALAGE;
+			//Arrondi au plus proche
+			temps_us[i] = (etat[i] + (1 << (FRACTION-1))) >> FRACTION;
+		}
+	}
+
+private:
+	enum { FRACTION = 4 };
+	//Temps filtrés en virgule fixe (4 bits de fraction)
+	int etat[NB_CAPTEURS];
+	//Premier cycle : pas encore d'état
+	bool premier;
+};
+
+//Deux filtres en série (par exemple médiane puis lissage)
+template<class Filtre1, class Filtre2>
+class FiltreSerie {
+public:
+	void filtre(int temps_us[NB_CAPTEURS]){
+		filtre1.filtre(temps_us);
+		filtre2.filtre(temps_us);
+	}
+
+private:
+	Filtre1 filtre1;
+	Filtre2 filtre2;
+};
+
+#endif
@@ -0,0 +1,122 @@
+#ifndef GAMME_H
+#define GAMME_H
+
+#include "parametres.h"
+#include "memoire.h"
+
+//Stratégies de réglage de la mesure des capteurs (acquisition en tâche de fond)
+//charge_us()       -> durée de charge des capacités pour la prochaine trame
+//decharge_max_us() -> fenêtre de décharge : un capteur pas déchargé est lu noir à cette valeur
+//trame_essai()     -> la prochaine trame essaie un autre réglage : elle sert à mesure() mais
+//                     n'est pas publiée, ses temps fausseraient le cycle de contrôle
+//mesure()          -> statistiques à partir d'une trame complète (appelé sous interruption)
+//Calculs entiers uniquement, appelés depuis l'interruption TIMER2
+
+//Charge et fenêtre fixes (réglage d'origine)
+class GammeFixe {
+public:
+	int charge_us() const { return CHARGE_US; }
+	int decharge_max_us() const { return DECHARGE_MAX_US; }
+	bool trame_essai() const { return false; }
+	void mesure(const int temps_us[NB_CAPTEURS]){}
+
+private:
+	enum {
+		CHARGE_US = 10,
+		DECHARGE_MAX_US = 5000
+	};
+};
+
+//Réglage automatique à partir des niveaux blanc et noir observés en course
+//Fenêtre : 3/2 du niveau noir, au-delà un capteur est forcément sur le sol ;
+//  le niveau noir monte d'un coup (une lecture à la fenêtre l'agrandit de moitié
+//  à la trame suivante) et ne redescend que lentement
+//Charge : toutes les ESSAI_CHARGE trames, une trame est chargée PAS_CHARGE_US de moins ;
+//  si son niveau blanc ne baisse pas, la charge plus courte suffit, sinon on rallonge ;
+//  ses temps, plus courts, tireraient le cycle de contrôle vers le blanc : elle ne lui
+//  est pas donnée
+//Seules les trames contrastées (noir > 2*blanc) sont utilisées : ligne perdue ou
+//ligne sous tous les capteurs ne déréglent rien
+class GammeAuto {
+public:
+	GammeAuto() : charge(CHARGE_DEPART_US), essai(false), trames(0),
+		blanc(0), noir(DECHARGE_MAX_US << FRACTION), fenetre(DECHARGE_MAX_US) {}
+
+	int charge_us() const { return essai ? charge - PAS_CHARGE_US : charge; }
+	int decharge_max_us() const { return fenetre; }
+	bool trame_essai() const { return essai; }
+
+	EN_RAM void mesure(const int temps_us[NB_CAPTEURS]){
+		char i;
+		int min = temps_us[0], max = temps_us[0];
+		bool essai_fini = essai;
+		essai = false;
+		for(i=1; i<NB_CAPTEURS; i++){
+			if(temps_us[i] < min) min = temps_us[i];
+			if(temps_us[i] > max) max = temps_us[i];
+		}
+		//Pas de contraste : rien à apprendre de cette trame
+		if(max <= 2*min)
+			return;
+
+		//Trame d'essai d'une charge plus courte : le blanc a-t-il baissé ?
+		if(essai_fini && blanc){
+			if((min << FRACTION) >= blanc - (blanc >> 3))
+				charge -= PAS_CHARGE_US;
+			else
+				charge += PAS_CHARGE_US;
+			if(charge < CHARGE_MIN_US + PAS_CHARGE_US)
+				charge = CHARGE_MIN_US + PAS_CHARGE_US;
+			if(charge > CHARGE_MAX_US)
+				charge = CHARGE_MAX_US;
+		}
+		else
+			blanc += ((min << FRACTION) - blanc) >> LISSAGE_BLANC;
+
+		if((max << FRACTION) > noir)
+			noir = max << FRACTION;
+		else
+			noir += ((max << FRACTION) - noir) >> LISSAGE_NOIR;
+		fenetre = (noir >> FRACTION) + (noir >> (FRACTION + 1));
+		if(fenetre < DECHARGE_MIN_US)
+			fenetre = DECHARGE_MIN_US;
+		if(fenetre > DECHARGE_MAX_US)
+			fenetre = DECHARGE_MAX_US;
+
+		if(++trames >= ESSAI_CHARGE){
+			trames = 0;
+			essai = true;
+		}
+	}
+
+private:
+	enum {
+		CHARGE_DEPART_US = 10,
+		CHARGE_MIN_US = 2,
+		CHARGE_MAX_US = 20,
+		PAS_CHARGE_US = 2,
+		//Trames entre deux essais de charge plus courte
+		ESSAI_CHARGE = 64,
+		DECHARGE_MIN_US = 500,
+		DECHARGE_MAX_US = 5000,
+		//Bits de fraction des niveaux (virgule fixe)
+		FRACTION = 4,
+		//Lissage des niveaux : 1/2^LISSAGE
+		LISSAGE_BLANC = 3,
+		LISSAGE_NOIR = 6
+	};
+
+	//Charge en cours
+	int charge;
+	//Prochaine trame chargée moins longtemps
+	volatile bool essai;
+	//Trames contrastées depuis le dernier essai
+	int trames;
+	//Niveaux blanc (minimum d'une trame) et noir (maximum) en virgule fixe
+	int blanc;
+	int noir;
+	//Fenêtre de décharge en cours
+	volatile int fenetre;
+};
+
+#endif
@@ -0,0 +1,67 @@
+#ifndef HORLOGE_H
+#define HORLOGE_H
+
+#include "mbed.h"
+
+//Date 64 bits en µs depuis le démarrage, à partir de us_ticker_read() (TIMER3, 32 bits)
+//us_ticker_read() repasse à zéro toutes les 71 minutes et Timer::read_us() devient
+//négatif au bout de 35 : les endurances et les essais longs ont besoin de plus
+//Les 32 bits de poids faible sont ceux du timer ; l'état est un seul mot, le nombre de
+//demi-tours du timer (bit 31 compris), avancé par le premier lecteur qui voit le bit 31
+//changer. Pas de section critique : lisible depuis la boucle comme depuis une
+//interruption, qui ne peut que faire avancer le mot à la même valeur
+//Il faut une lecture au moins toutes les 35 minutes : le Ticker d'entretien s'en charge
+//Le timer est arrêté en sommeil profond (attente du bouton) : la date aussi
+class Horloge {
+public:
+	Horloge() : demi_tours(0) {}
+
+	//Lecture au moins toutes les 35 minutes, même sans personne pour lire la date
+	void demarre(){
+		entretien.attach_us(this, &Horloge::entretient, PERIODE_ENTRETIEN_US);
+	}
+
+	//Date en µs depuis le démarrage, croissante
+	unsigned long long us(){
+		//Le mot d'état est lu avant le timer : il ne peut être en avance sur lui
+		unsigned int etat = demi_tours;
+		unsigned int bas = us_ticker_read();
+		//Le bit 31 du timer a changé depuis la dernière avance
+		if((bas >> 31) != (etat & 1)){
+			avance(etat);
+			etat++;
+		}
+		return ((unsigned long long)(etat >> 1) << 32) | bas;
+	}
+
+private:
+	enum {
+		//10 minutes, bien en dessous du demi-tour de 35 minutes
+		PERIODE_ENTRETIEN_US = 600000000
+	};
+
+	//Passage de etat à etat + 1, sauf si une interruption l'a déjà fait
+	//(LDREX/STREX : la réservation est perdue si une interruption écrit entre les deux)
+	void avance(unsigned int etat){
+#if defined(__CC_ARM) || defined(__arm__)
+		do{
+			if(__LDREXW((uint32_t *)&demi_tours) != etat){
+				__CLREX();
+				return;
+			}
+		}while(__STREXW(etat + 1, (uint32_t *)&demi_tours));
+#else
+		if(demi_tours == etat)
+			demi_tours = etat + 1;
+#endif
+	}
+
+	void entretient(){
+		us();
+	}
+
+	volatile unsigned int demi_tours;
+	Ticker entretien;
+};
+
+#endif
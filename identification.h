@@ -0,0 +1,369 @@
+#ifndef IDENTIFICATION_H
+#define IDENTIFICATION_H
+
+#include <math.h>
+#include "parametres.h"
+#include "virgule_fixe.h"
+
+//Identification des moteurs : zone morte, gain et constante de temps de chacun
+//Les moteurs sont essayés l'un après l'autre, l'autre arrêté, avec un arrêt complet
+//entre deux essais :
+//rampe    -> PWM montant lentement depuis 0 : la roue démarre à la sortie de la zone morte
+//            (corrigée du retard de détection une fois le gain et tau connus)
+//échelons -> PWM de plus en plus fortes ; chaque réponse est ajustée sur celle d'un
+//            premier ordre, x = v*(t - tau*(1 - exp(-t/tau))) : vitesse établie v et
+//            constante de temps tau. Le gain est la pente de v en fonction de la PWM
+//Mesure :
+//LIGNE = true  -> position de la ligne sous la barrette : robot posé sur la ligne, une seule
+//                 roue tourne, le robot pivote autour de l'autre et la ligne traverse la barrette
+//                 (vers la droite pour le moteur droit, vers la gauche pour le moteur gauche :
+//                 chaque essai ramène la ligne pour le suivant). L'essai s'arrête quand
+//                 la ligne atteint le bord de la barrette ; si elle n'est pas du bon côté
+//                 (roue dans sa zone morte, roue lancée au-delà du bord), elle est ramenée
+//                 avant l'essai. La ligne ne se déplace pas tout à fait proportionnellement
+//                 à la rotation de la roue (pivot, barycentre des capteurs) : zone morte fiable,
+//                 gain et constante de temps approchés
+//LIGNE = false -> codeurs sur les roues (codeurs.h), essais de durée fixe
+//Aucun accès au matériel ; les calculs d'ajustement sont faits à la fin de chaque essai,
+//robot arrêté, en flottant : cycle() ne fait que mesurer, et quand un échelon se termine
+//(analyse_en_attente()), l'appelant arrête les moteurs et appelle termine_echelon() hors
+//du cycle surveillé (plus de 100 ms sur le LPC1768, outils/temps_identification.cpp)
+
+enum {
+	MOTEUR_DROIT = 0,
+	MOTEUR_GAUCHE = 1
+};
+
+//Caractéristique d'un moteur
+//zone_morte      -> PWM (‰) en dessous de laquelle la roue ne tourne pas
+//gain            -> vitesse établie par ‰ de PWM au-dessus de la zone morte,
+//                   en unités de mesure (Q8) par cycle, Q16
+//constante_temps -> constante de temps du premier ordre (µs)
+struct CaracteristiqueMoteur {
+	int zone_morte;
+	int gain;
+	int constante_temps;
+};
+
+//Linéarisation des moteurs par leurs caractéristiques (appliquée par Moteurs)
+//Vitesse demandée (‰ de la vitesse maximale du moteur le moins rapide) -> PWM (‰) :
+//0 -> arrêt, sinon la PWM part de la zone morte du moteur, et une même vitesse donne
+//la même rotation des deux roues. Calcul entier, pentes en Q16
+class LinearisationMoteurs {
+public:
+	LinearisationMoteurs() : active(false) {}
+
+	//Renvoie false (linéarisation inchangée) si une caractéristique est inutilisable
+	bool regle(const CaracteristiqueMoteur &droite, const CaracteristiqueMoteur &gauche){
+		const CaracteristiqueMoteur *c[2] = {&droite, &gauche};
+		long long maximum[2], commun;
+		int m;
+		for(m=0; m<2; m++){
+			if(c[m]->gain <= 0 || c[m]->zone_morte >= 1000)
+				return false;
+			//Vitesse à pleine PWM (unités de l'identification)
+			maximum[m] = (long long)c[m]->gain * (1000 - c[m]->zone_morte);
+		}
+		commun = maximum[MOTEUR_DROIT] < maximum[MOTEUR_GAUCHE] ? maximum[MOTEUR_DROIT] : maximum[MOTEUR_GAUCHE];
+		for(m=0; m<2; m++){
+			zone[m] = c[m]->zone_morte;
+			pente[m] = (int)((commun << 16) / ((long long)c[m]->gain * 1000));
+		}
+		active = true;
+		return true;
+	}
+
+	//PWM (‰) qui donne la vitesse demandée au moteur m (inchangée sans réglage)
+	int pwm(int m, int vitesse) const {
+		if(!active)
+			return vitesse;
+		if(vitesse <= 0)
+			return 0;
+		return borne(zone[m] + produit<16, 0, 0>(pente[m], vitesse), 0, 1000);
+	}
+
+private:
+	bool active;
+	//PWM de sortie de zone morte (‰) et PWM par ‰ de vitesse (Q16) de chaque moteur
+	int zone[2];
+	int pente[2];
+};
+
+template<bool LIGNE>
+class IdentificationMoteurs {
+public:
+	enum {
+		//Rampe : 1‰ de PWM tous les RAMPE cycles
+		RAMPE = 4,
+		//Échelons de PWM (‰) : PREMIER, PREMIER+PAS, ...
+		ECHELONS = 8,
+		PREMIER = 100,
+		PAS = 70,
+		//Essais : deux rampes puis les échelons, moteur droit et gauche en alternance
+		ESSAIS = 2 + 2*ECHELONS,
+		//Arrêt entre deux essais (cycles) : la roue repart de l'arrêt
+		ARRET = 150,
+		//Durée d'un échelon : maximale avec la ligne, fixe avec les codeurs
+		DUREE = 1000,
+		//Bord de la barrette (Q8) : fin de l'essai quand la ligne y arrive
+		BORD = ((NB_CAPTEURS - 2) << 8) / 2,
+		//PWM (‰) de départ de la rampe qui ramène la ligne avant un essai
+		RETOUR = 100,
+		//Déplacement minimal (Q8, un demi-pas) pour que la roue soit considérée en mouvement
+		MOUVEMENT = 128,
+		//Cycles sans voir la ligne tolérés pendant un essai (ligne entre deux capteurs)
+		PERTE = 10,
+		//Points gardés par échelon (sous-échantillonnage quand il est plein)
+		POINTS = 256,
+		//Constantes de temps cherchées (cycles)
+		TAU_MIN = 1,
+		TAU_MAX = 250
+	};
+
+	IdentificationMoteurs() : essai(0), cycles(0), en_arret(true), en_retour(false),
+		moteur_retour(MOTEUR_GAUCHE), jusqu_au_bord(false), derniere(0), sans_ligne(0), depart(0), n(0), decimation(1), a_analyser(false), terminee_(false) {
+		int m, e;
+		for(m=0; m<2; m++){
+			demarrage[m] = 0;
+			for(e=0; e<ECHELONS; e++)
+				vitesse[m][e] = constante[m][e] = 0.0f;
+			resultat[m].zone_morte = resultat[m].gain = resultat[m].constante_temps = 0;
+		}
+	}
+
+	//Un cycle : position_droite, position_gauche -> mesure du déplacement de chaque roue (Q8)
+	//(avec la ligne, la même position de la ligne pour les deux). valide : mesure disponible
+	//Renvoie la PWM (‰) à appliquer à chaque moteur dans pwm_droite, pwm_gauche
+	void cycle(bool valide, int position_droite, int position_gauche, int &pwm_droite, int &pwm_gauche){
+		pwm_droite = pwm_gauche = 0;
+		if(terminee_ || a_analyser)
+			return;
+		int position = moteur() == MOTEUR_DROIT ? position_droite : position_gauche;
+		cycles++;
+		if(valide){
+			derniere = position;
+			sans_ligne = 0;
+		}
+		else
+			sans_ligne++;
+
+		//Ligne ramenée sous la barrette, du côté où démarre l'essai, puis nouvel arrêt
+		//PWM en rampe : la roue démarre juste au-dessus de sa zone morte et dépasse peu
+		if(en_retour){
+			bool arrivee = jusqu_au_bord ? valide && cote_depart()*position >= BORD : valide;
+			if(cycles >= DUREE)
+				terminee_ = true;
+			else if(arrivee){
+				en_retour = false;
+				en_arret = true;
+				cycles = 0;
+			}
+			else
+				(moteur_retour == MOTEUR_DROIT ? pwm_droite : pwm_gauche) = RETOUR + cycles < 1000 ? RETOUR + cycles : 1000;
+			return;
+		}
+
+		//Arrêt entre deux essais, puis départ de l'essai suivant
+		if(en_arret){
+			if(cycles < ARRET)
+				return;
+			//Ligne perdue au-delà du bord de départ : la roue essayée la fait revenir
+			//Ligne de l'autre côté : l'autre roue la ramène jusqu'au bord de départ
+			if(LIGNE && !(valide && cote_depart()*position >= 0)){
+				bool au_dela = !valide && cote_depart()*derniere > 0;
+				moteur_retour = au_dela ? moteur() : 1 - moteur();
+				jusqu_au_bord = !au_dela;
+				en_retour = true;
+				en_arret = false;
+				cycles = 0;
+				return;
+			}
+			en_arret = false;
+			cycles = 0;
+			depart = position;
+			n = 0;
+			decimation = 1;
+			return;
+		}
+
+		//Déplacement depuis le départ, dans le sens de la roue essayée
+		//(ligne : depuis la dernière position vue)
+		if(LIGNE)
+			position = derniere;
+		int x = (LIGNE && moteur() == MOTEUR_GAUCHE) ? depart - position : position - depart;
+		bool ligne_finie = LIGNE && (sans_ligne > PERTE || (moteur() == MOTEUR_DROIT ? position >= BORD : position <= -BORD));
+		if(rampe()){
+			//Fin de la rampe au premier mouvement de la roue
+			if(x >= MOUVEMENT || ligne_finie || cycles >= 1000*RAMPE){
+				demarrage[moteur()] = x >= MOUVEMENT ? cycles/RAMPE : 0;
+				suivant();
+				return;
+			}
+			(moteur() == MOTEUR_DROIT ? pwm_droite : pwm_gauche) = cycles/RAMPE;
+			return;
+		}
+		if(valide && cycles % decimation == 0)
+			ajoute(cycles, x);
+		//Fin de l'échelon : moteurs arrêtés, l'ajustement attend termine_echelon()
+		if(cycles >= DUREE || ligne_finie){
+			a_analyser = true;
+			return;
+		}
+		(moteur() == MOTEUR_DROIT ? pwm_droite : pwm_gauche) = pwm_echelon();
+	}
+
+	//Échelon terminé, ajustement à faire par termine_echelon()
+	bool analyse_en_attente() const { return a_analyser; }
+	//Points mesurés de l'échelon en attente (le coût de l'ajustement leur est proportionnel)
+	int points() const { return n; }
+
+	//Ajustement de l'échelon terminé puis passage à l'essai suivant (caractéristiques
+	//calculées après le dernier) : long, à faire robot arrêté hors du cycle de contrôle
+	void termine_echelon(){
+		if(!a_analyser)
+			return;
+		a_analyser = false;
+		analyse();
+		suivant();
+	}
+
+	bool terminee() const { return terminee_; }
+	//Les deux moteurs ont une caractéristique
+	bool reussie() const { return terminee_ && resultat[MOTEUR_DROIT].gain > 0 && resultat[MOTEUR_GAUCHE].gain > 0; }
+	const CaracteristiqueMoteur &caracteristique(int m) const { return resultat[m]; }
+	//Essai en cours : moteur, rampe ou échelon, PWM de l'échelon
+	int moteur() const { return essai % 2; }
+	bool rampe() const { return essai < 2; }
+	int pwm_echelon() const { return PREMIER + echelon()*PAS; }
+
+private:
+	int echelon() const { return (essai - 2) / 2; }
+
+	//Côté de la barrette où la ligne doit être au départ de l'essai (le moteur droit
+	//la fait passer de gauche à droite)
+	int cote_depart() const { return moteur() == MOTEUR_DROIT ? -1 : 1; }
+
+	void ajoute(int t, int x){
+		//Tampon plein : on garde un point sur deux et on espace les suivants
+		if(n == POINTS){
+			int i;
+			for(i=0; i<POINTS/2; i++){
+				temps[i] = temps[2*i];
+				deplacement[i] = deplacement[2*i];
+			}
+			n = POINTS/2;
+			decimation *= 2;
+		}
+		temps[n] = t;
+		deplacement[n] = x;
+		n++;
+	}
+
+	//Vitesse établie et constante de temps de l'échelon
+	//Pour tau donné, la meilleure vitesse est directe (moindres carrés) ; tau est cherché
+	//par section dorée entre TAU_MIN et TAU_MAX cycles
+	void analyse(){
+		float a = TAU_MIN, b = TAU_MAX, c, d, v;
+		int i;
+		vitesse[moteur()][echelon()] = constante[moteur()][echelon()] = 0.0f;
+		if(n < 4 || deplacement[n-1] < MOUVEMENT)
+			return;
+		for(i=0; i<30; i++){
+			c = b - 0.618034f*(b - a);
+			d = a + 0.618034f*(b - a);
+			if(ecart(c, v) < ecart(d, v))
+				b = d;
+			else
+				a = c;
+		}
+		ecart((a + b)/2, v);
+		if(v <= 0)
+			return;
+		vitesse[moteur()][echelon()] = v;
+		constante[moteur()][echelon()] = (a + b)/2;
+	}
+
+	//Écart quadratique entre la réponse mesurée et celle d'un premier ordre de constante tau
+	float ecart(float tau, float &v) const {
+		float sff = 0, sfx = 0, sxx = 0, f;
+		int i;
+		for(i=0; i<n; i++){
+			f = temps[i] - tau*(1.0f - expf(-temps[i]/tau));
+			sff += f*f;
+			sfx += f*deplacement[i];
+			sxx += (float)deplacement[i]*deplacement[i];
+		}
+		v = sfx/sff;
+		return sxx - v*sfx;
+	}
+
+	//Essai suivant : on alterne les moteurs pour ramener la ligne sous la barrette
+	void suivant(){
+		en_arret = true;
+		cycles = 0;
+		if(++essai < ESSAIS)
+			return;
+		caracterise(MOTEUR_DROIT);
+		caracterise(MOTEUR_GAUCHE);
+		terminee_ = true;
+	}
+
+	//Gain : pente de v en fonction de la PWM sur les échelons où la roue a tourné
+	//Zone morte : PWM de démarrage pendant la rampe, moins ce qu'elle a monté le temps que
+	//la roue parcoure MOUVEMENT (x = gain*pente*t²/2) et pendant tau
+	void caracterise(int m){
+		float sp = 0, sv = 0, spp = 0, spv = 0, tau = 0, gain, pwm, pente = 1.0f/RAMPE;
+		int e, k = 0;
+		for(e=0; e<ECHELONS; e++){
+			if(vitesse[m][e] <= 0)
+				continue;
+			pwm = PREMIER + e*PAS;
+			sp += pwm;
+			sv += vitesse[m][e];
+			spp += pwm*pwm;
+			spv += pwm*vitesse[m][e];
+			tau += constante[m][e];
+			k++;
+		}
+		if(k < 2 || demarrage[m] == 0)
+			return;
+		gain = (k*spv - sp*sv) / (k*spp - sp*sp);
+		if(gain <= 0)
+			return;
+		tau /= k;
+		resultat[m].gain = (int)(gain * 65536.0f);
+		resultat[m].zone_morte = (int)(demarrage[m] - sqrtf(2.0f*MOUVEMENT*pente/gain) - pente*tau + 0.5f);
+		if(resultat[m].zone_morte < 0)
+			resultat[m].zone_morte = 0;
+		resultat[m].constante_temps = (int)(tau * PERIODE_CONTROLE_US);
+	}
+
+	//Essai en cours (rampe droite, rampe gauche, puis échelons droite/gauche)
+	int essai;
+	int cycles;
+	bool en_arret;
+	//Retour de la ligne : moteur utilisé, jusqu'au bord de départ ou jusqu'à la revoir
+	bool en_retour;
+	int moteur_retour;
+	bool jusqu_au_bord;
+	//Dernière position de la ligne vue (Q8) et cycles depuis
+	int derniere;
+	int sans_ligne;
+	//Position au départ de l'échelon et réponse mesurée (cycles, déplacement Q8)
+	int depart;
+	int temps[POINTS];
+	int deplacement[POINTS];
+	int n;
+	int decimation;
+	//Échelon terminé, pas encore ajusté
+	bool a_analyser;
+	//PWM de démarrage de chaque roue pendant la rampe (‰)
+	int demarrage[2];
+	//Vitesse établie (Q8/cycle) et constante de temps (cycles) de chaque échelon
+	float vitesse[2][ECHELONS];
+	float constante[2][ECHELONS];
+	CaracteristiqueMoteur resultat[2];
+	bool terminee_;
+};
+
+#endif
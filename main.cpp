@@ -0,0 +1,205 @@
+#include "mbed.h"
+#include "robot.h"
+#include "memoire.h"
+#include "pile.h"
+#include "horloge.h"
+#include "surveillance.h"
+#include "defaut.h"
+#include "priorites.h"
+#include "cadence.h"
+#include "configurations.h"
+
+//Réglage de la mesure des capteurs (acquisition en tâche de fond)
+#if GAMME_AUTO
+typedef GammeAuto GammeCapteurs;
+#else
+typedef GammeFixe GammeCapteurs;
+#endif
+
+//Configurations du robot : calcul du cycle (configurations.h) + matériel
+#if NB_CAPTEURS == 6
+//1 -> seuil fixe, règles souples, vitesses lentes (ancien main1.cpp)
+struct Config1 : ConfigControle1 {
+	typedef CapteursRC<BrochesCapteurs> Capteurs;
+	typedef CalibrageFixe<800> Calibrage;
+};
+
+//2 -> calibrage au bouton, règles strictes, vitesses rapides (ancien main2.cpp)
+struct Config2 : ConfigControle2 {
+	typedef CapteursRC<BrochesCapteurs> Capteurs;
+	typedef CalibrageBouton Calibrage;
+};
+
+//6 -> comme 2 avec acquisition en tâche de fond, médiane sur 3 lectures et suivi
+//     des niveaux noir/blanc
+struct Config6 : ConfigControle6 {
+	typedef CapteursPipeline<BrochesCapteurs, 8, REJET_AMBIANT, GammeCapteurs> Capteurs;
+	typedef CalibrageBouton Calibrage;
+};
+#endif
+
+//3 -> comme 6 avec la décision par groupes de capteurs, pour une barrette
+//     de NB_CAPTEURS quelconque (BrochesCapteurs dans capteurs.h)
+struct Config3 : ConfigControle3 {
+	typedef CapteursPipeline<BrochesCapteurs, 8, REJET_AMBIANT, GammeCapteurs> Capteurs;
+	typedef CalibrageBouton Calibrage;
+};
+
+//4 -> comme 3 avec une commande continue des moteurs (position de la ligne estimée
+//     par un filtre de Kalman, correcteur proportionnel-dérivé)
+struct Config4 : ConfigControle4 {
+	typedef CapteursPipeline<BrochesCapteurs, 8, REJET_AMBIANT, GammeCapteurs> Capteurs;
+	typedef CalibrageBouton Calibrage;
+};
+
+//5 -> comme 3 avec l'anticipation des virages (courbure estimée)
+struct Config5 : ConfigControle5 {
+	typedef CapteursPipeline<BrochesCapteurs, 8, REJET_AMBIANT, GammeCapteurs> Capteurs;
+	typedef CalibrageBouton Calibrage;
+};
+
+//Choix de la configuration du robot à la compilation
+#ifndef CONFIG_ROBOT
+#define CONFIG_ROBOT 2
+#endif
+
+#if (CONFIG_ROBOT < 3 || CONFIG_ROBOT == 6) && NB_CAPTEURS != 6
+#error "CONFIG_ROBOT 1, 2 et 6 : règles de décision écrites pour 6 capteurs (CONFIG_ROBOT 3 à 5 sinon)"
+#endif
+
+#if AUTO_REGLAGE && CONFIG_ROBOT != 4
+#error "AUTO_REGLAGE : réglage du correcteur PD de CONFIG_ROBOT 4"
+#endif
+
+#if CONFIG_ROBOT == 1
+typedef Robot<Config1> RobotChoisi;
+#elif CONFIG_ROBOT == 2
+typedef Robot<Config2> RobotChoisi;
+#elif CONFIG_ROBOT == 3
+typedef Robot<Config3> RobotChoisi;
+#elif CONFIG_ROBOT == 4
+typedef Robot<Config4> RobotChoisi;
+#elif CONFIG_ROBOT == 5
+typedef Robot<Config5> RobotChoisi;
+#elif CONFIG_ROBOT == 6
+typedef Robot<Config6> RobotChoisi;
+#else
+#error "CONFIG_ROBOT inconnue"
+#endif
+
+//Date 64 bits depuis le démarrage (rapports, boîte noire)
+Horloge horloge;
+//serial Putty
+Serial foutPC(USBTX,USBRX);
+//Messages envoyés sous interruption sur foutPC, file dans la banque AHBSRAM1
+FileTelemetrie file_telemetrie EN_AHBSRAM1;
+Telemetrie telemetrie(foutPC, file_telemetrie);
+//Boîte noire dans la banque AHBSRAM0 (16 Ko inutilisés par mbed)
+Enregistrement tampon_boite_noire[TAILLE_BOITE_NOIRE] EN_AHBSRAM0;
+BoiteNoire boite_noire(tampon_boite_noire, TAILLE_BOITE_NOIRE);
+//Coupure des moteurs si la boucle de contrôle se bloque, chien de garde
+Surveillance surveillance(boite_noire);
+//Dernier défaut matériel, conservé d'un démarrage à l'autre
+EnregistrementDefaut defaut_precedent EN_NOINIT;
+#if BOITE_NOIRE_FICHIER
+LocalFileSystem local("local");
+#endif
+#if IDENTIFICATION_MOTEURS
+//Mesures de l'identification des moteurs dans la banque AHBSRAM1
+IdentificationMoteurs<!CODEURS_ROUES> identification EN_AHBSRAM1;
+#define TAILLE_IDENTIFICATION sizeof(identification)
+#else
+#define TAILLE_IDENTIFICATION 0
+#endif
+//Robot suiveur de ligne
+RobotChoisi robot;
+//Occupation des piles de main() et des interruptions
+SurveillancePiles piles;
+//Instance servie par l'interruption du tick de contrôle (TIMER1)
+CadenceControle *CadenceControle::instance = 0;
+#if MESURE_LATENCE
+//Pire latence entre l'événement qui cadence le cycle et la reprise de la boucle
+MesureLatence latence_cycle;
+#endif
+
+//Budget de chaque région de RAM (memoire.h)
+VERIFIE_BUDGET(AHBSRAM0, sizeof(tampon_boite_noire));
+VERIFIE_BUDGET(AHBSRAM1, sizeof(file_telemetrie) + TAILLE_IDENTIFICATION);
+VERIFIE_BUDGET(NOINIT, sizeof(defaut_precedent));
+VERIFIE_BUDGET(IRAM1, sizeof(robot) + sizeof(boite_noire) + sizeof(telemetrie) + sizeof(foutPC) + sizeof(piles) + sizeof(horloge) + sizeof(surveillance));
+
+//Défaut matériel : moteurs coupés, défaut capturé pour le démarrage suivant,
+//boîte noire figée et vidée sur la liaison série, puis redémarrage
+extern "C" void defaut_materiel(const unsigned int *cadre, unsigned int exc_return){
+	Moteurs::coupe_sorties();
+	capture_processeur(defaut_precedent, cadre, exc_return);
+	defaut_precedent.cycles = surveillance.cycles();
+	defaut_precedent.date_ms = (unsigned int)(horloge.us() / 1000);
+	defaut_precedent.nombre_cycles = boite_noire.nombre();
+	if(boite_noire.nombre())
+		defaut_precedent.dernier = boite_noire.lit(boite_noire.nombre() - 1);
+	defaut_precedent.controle = controle_defaut(defaut_precedent);
+	boite_noire.fige(GEL_DEFAUT);
+	surveillance.suspend_chien();
+	vide_boite_serie(boite_noire);
+	NVIC_SystemReset();
+}
+
+//Entrée des gestionnaires de défaut : la pile du code fautif (bit 2 de EXC_RETURN)
+//est passée à defaut_materiel() sans rien empiler avant
+//MemManage, BusFault et UsageFault sont activés dans demarrage() (sinon HardFault)
+#if defined(__CC_ARM)
+extern "C" __asm void HardFault_Handler(void){
+	TST lr, #4
+	ITE EQ
+	MRSEQ r0, MSP
+	MRSNE r0, PSP
+	MOV r1, lr
+	B __cpp(defaut_materiel)
+}
+extern "C" __asm void MemManage_Handler(void){
+	B __cpp(HardFault_Handler)
+}
+extern "C" __asm void BusFault_Handler(void){
+	B __cpp(HardFault_Handler)
+}
+extern "C" __asm void UsageFault_Handler(void){
+	B __cpp(HardFault_Handler)
+}
+#else
+extern "C" __attribute__((naked)) void HardFault_Handler(void){
+	__asm volatile("tst lr, #4\n\tite eq\n\tmrseq r0, msp\n\tmrsne r0, psp\n\tmov r1, lr\n\tb defaut_materiel");
+}
+extern "C" __attribute__((naked)) void MemManage_Handler(void){
+	__asm volatile("b HardFault_Handler");
+}
+extern "C" __attribute__((naked)) void BusFault_Handler(void){
+	__asm volatile("b HardFault_Handler");
+}
+extern "C" __attribute__((naked)) void UsageFault_Handler(void){
+	__asm volatile("b HardFault_Handler");
+}
+#endif
+
+//Suite de main(), sur la pile principale
+static void demarrage(){
+	//Défauts distincts (CFSR) plutôt que tous remontés en HardFault
+	SCB->SHCSR |= SCB_SHCSR_MEMFAULTENA_Msk | SCB_SHCSR_BUSFAULTENA_Msk | SCB_SHCSR_USGFAULTENA_Msk;
+	//Priorités des interruptions, avant le démarrage des périphériques
+	applique_priorites();
+	horloge.demarre();
+	foutPC.baud(VITESSE_SERIE);
+	//Défaut de la session précédente, envoyé avant la télémétrie (écriture bloquante)
+	if(defaut_valide(defaut_precedent)){
+		rapporte_defaut(foutPC, defaut_precedent);
+		defaut_precedent.magie = 0;
+	}
+	telemetrie.demarre();
+	surveillance.demarre();
+	robot.init();
+	robot.boucle();
+}
+
+int main(){
+	piles.demarre(demarrage);
+}
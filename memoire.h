@@ -0,0 +1,55 @@
+#ifndef MEMOIRE_H
+#define MEMOIRE_H
+
+#include "parametres.h"
+
+//Placement des gros tampons dans les banques de RAM AHB (voir LPC1768.sct), la RAM
+//locale (RW_IRAM1) restant à la pile et à l'état du cycle de contrôle
+//RW_IRAM2 : AHBSRAM0, 16 Ko à 0x2007C000 -> boîte noire
+//RW_IRAM3 : AHBSRAM1, 16 Ko à 0x20080000 -> file de la télémétrie, mesures de l'identification
+//RW_NOINIT : les 256 derniers octets de AHBSRAM1, ni copiés ni mis à zéro au démarrage
+//            -> capture du dernier défaut matériel (defaut.h), qui survit au redémarrage
+//zero_init : le tampon est mis à zéro au démarrage, sans occuper de place en flash
+//(un objet est ensuite construit comme les autres globaux)
+//Sur PC (outils) les attributs sont ignorés
+
+#if defined(__CC_ARM)
+#define EN_AHBSRAM0 __attribute__((section("AHBSRAM0"), zero_init))
+#define EN_AHBSRAM1 __attribute__((section("AHBSRAM1"), zero_init))
+#define EN_NOINIT __attribute__((section("NOINIT"), zero_init))
+#else
+#define EN_AHBSRAM0
+#define EN_AHBSRAM1
+#define EN_NOINIT
+#endif
+
+//Code du cycle de contrôle exécuté depuis la RAM locale (région ER_RAMCODE, copiée depuis
+//la flash au démarrage) : la flash a 4 états d'attente à 96 MHz, que l'accélérateur masque
+//en ligne droite mais pas après un saut. La RAM locale est sur le bus I-Code, sans attente
+//La table des vecteurs y est déjà : NVIC_SetVector() la recopie à 0x10000000
+//Les fonctions appelées et non intégrées restent en flash (veneer de saut long)
+#if defined(__CC_ARM) && CODE_EN_RAM
+#define EN_RAM __attribute__((section("RAMCODE")))
+#else
+#define EN_RAM
+#endif
+
+//Budget de chaque région de RAM (octets), à garder cohérent avec LPC1768.sct
+//RW_IRAM1 : RAM locale après les vecteurs (0xC8) et le code en RAM (ER_RAMCODE, 8 Ko),
+//moins la réserve de la pile et du tas (mbed, printf, LocalFileSystem)
+//Les données de la bibliothèque mbed (quelques centaines d'octets) sont dans la réserve
+//Avec PILE_PRINCIPALE, la pile de main() est un tableau compté dans RW_IRAM1 : la réserve
+//ne sert plus qu'au tas et aux interruptions (occupation mesurée par pile.h)
+#define RESERVE_PILE_TAS 0x2000
+#define BUDGET_IRAM1 (0x8000 - 0xC8 - (CODE_EN_RAM ? 0x2000 : 0) - RESERVE_PILE_TAS)
+#define BUDGET_AHBSRAM0 0x4000
+#define BUDGET_AHBSRAM1 0x3F00
+#define BUDGET_NOINIT 0x100
+
+//Vérification à la compilation : erreur (tableau de taille -1) si les objets
+//placés dans la région dépassent son budget. Le rapport après l'édition de liens
+//(outils/rapport_memoire.cpp sur le fichier .map) donne l'occupation réelle
+#define VERIFIE_BUDGET(region, taille) \
+	typedef char budget_##region##_depasse[(taille) <= BUDGET_##region ? 1 : -1]
+
+#endif
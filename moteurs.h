@@ -0,0 +1,92 @@
+#ifndef MOTEURS_H
+#define MOTEURS_H
+
+#include "mbed.h"
+#include "parametres.h"
+#include "virgule_fixe.h"
+#include "memoire.h"
+#include "identification.h"
+
+//Commande des deux moteurs, vitesses en ‰
+//Avec compense(), les vitesses demandées sont linéarisées (LinearisationMoteurs) : 0 -> arrêt,
+//sinon la PWM part de la zone morte du moteur, et une même vitesse donne la même rotation
+//des deux roues (1000 -> vitesse maximale du moteur le moins rapide)
+class Moteurs {
+public:
+	Moteurs() : E1(P2_2), E2(P2_3), M1(P0_5), M2(P0_4), periode(0) {}
+
+	//Initialisation des sortie PWM des moteurs
+	void initPWM(){
+		E1.period_us(PERIODE_PWM_US);
+		E2.period_us(PERIODE_PWM_US);
+
+		E1.pulsewidth_us(0);
+		E2.pulsewidth_us(0);
+
+		M1 = 0;
+		M2 = 0;
+
+		//Période PWM en coups d'horloge, fixée par period_us()
+		periode = LPC_PWM1->MR0;
+	}
+
+	//Applique les vitesses calculées (‰ de la période PWM, ou de la vitesse
+	//maximale commune avec la compensation)
+	EN_RAM void applique(int vitesse_droite, int vitesse_gauche){
+		applique_pwm(linearisation.pwm(MOTEUR_DROIT, vitesse_droite), linearisation.pwm(MOTEUR_GAUCHE, vitesse_gauche));
+	}
+
+	//PWM (‰) appliquées telles quelles (identification des moteurs)
+	//E1 et E2 sont les sorties PWM1.3 et PWM1.4 : écriture directe de MR3 et MR4,
+	//sans le calcul flottant de PwmOut::pulsewidth()
+	EN_RAM void applique_pwm(int pwm_droite, int pwm_gauche){
+		//mise a jour des caracteristiques des moteurs
+		LPC_PWM1->MR3 = largeur(pwm_droite);
+		LPC_PWM1->MR4 = largeur(pwm_gauche);
+		//Prises en compte au début de la période suivante
+		LPC_PWM1->LER |= (1 << 3) | (1 << 4);
+	}
+
+	//Active la linéarisation à partir des caractéristiques identifiées
+	void compense(const CaracteristiqueMoteur &droite, const CaracteristiqueMoteur &gauche){
+		linearisation.regle(droite, gauche);
+	}
+
+	//Arrêt des deux moteurs
+	void arret(){
+		applique_pwm(0, 0);
+	}
+
+	//Coupure de sécurité, utilisable sous interruption (surveillance.h) : les broches
+	//P2.2 et P2.3 quittent la PWM pour des sorties à 0 jusqu'au prochain démarrage,
+	//quoi que la boucle écrive ensuite dans MR3 et MR4
+	static void coupe_sorties(){
+		LPC_GPIO2->FIOCLR = (1 << 2) | (1 << 3);
+		LPC_GPIO2->FIODIR |= (1 << 2) | (1 << 3);
+		LPC_PINCON->PINSEL4 &= ~(0xFu << 4);
+		LPC_PWM1->MR3 = 0;
+		LPC_PWM1->MR4 = 0;
+		LPC_PWM1->LER |= (1 << 3) | (1 << 4);
+	}
+
+private:
+	//Valeur de comparaison pour une PWM en ‰
+	unsigned int largeur(int pwm) const {
+		//Comme dans pwmout_pulsewidth_us() : jamais égale à MR0, qui fait perdre une période
+		if(pwm >= 1000)
+			return periode + 1;
+		return periode * (unsigned int)borne(pwm, 0, 1000) / 1000;
+	}
+
+	//Pin pwm vitesse du moteur
+	PwmOut E1;
+	PwmOut E2;
+	//Pin sens du moteur
+	DigitalOut M1;
+	DigitalOut M2;
+	//Période PWM (MR0)
+	unsigned int periode;
+	LinearisationMoteurs linearisation;
+};
+
+#endif
@@ -0,0 +1,121 @@
+//Banc d'essai des filtres sur PC à partir de traces enregistrées
+//
+//Compilation : g++ -O2 -I.. bench_filtre.cpp -o bench_filtre
+//Utilisation : ./bench_filtre trace.txt [seuil]
+//
+//La trace est la sortie Putty de print_temps() ("Temps du capteurs n°1 : 523")
+//ou un fichier texte avec les NB_CAPTEURS temps d'une lecture par ligne.
+//Pour chaque filtre on affiche le temps de calcul par lecture et le nombre
+//de changements de direction (mesure des "à-coups" du robot).
+//Les temps sur PC ne servent qu'à comparer les filtres entre eux : le budget en µs
+//(BUDGET_FILTRE_US) est vérifié sur le robot avec MESURE_CYCLES.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <vector>
+
+#include "filtre.h"
+#include "decision.h"
+
+//Décision utilisée pour compter les changements de direction
+#if NB_CAPTEURS == 6
+typedef DecisionStricte DecisionBanc;
+#else
+typedef DecisionSegments DecisionBanc;
+#endif
+
+//Nombre de passages sur la trace pour la mesure du temps de calcul
+#define REPETITIONS 200
+
+//Empêche le compilateur de supprimer le calcul mesuré
+static volatile int puits;
+
+//Lit la trace : une lecture = NB_CAPTEURS temps consécutifs
+static bool lire_trace(const char *nom, std::vector<int> &temps){
+	FILE *f = fopen(nom, "r");
+	if(!f)
+		return false;
+	char ligne[256];
+	while(fgets(ligne, sizeof(ligne), f)){
+		//Format print_temps() : le temps suit le dernier ':'
+		const char *p = strrchr(ligne, ':');
+		if(p){
+			temps.push_back(atoi(p+1));
+			continue;
+		}
+		//Format brut : plusieurs temps par ligne
+		char *c = ligne, *fin;
+		for(long v = strtol(c, &fin, 10); fin != c; v = strtol(c, &fin, 10)){
+			temps.push_back((int)v);
+			c = fin;
+		}
+	}
+	fclose(f);
+	temps.resize(temps.size() - temps.size()%NB_CAPTEURS);
+	return true;
+}
+
+template<class Filtre>
+static void bench(const char *nom, const std::vector<int> &trace, int seuil){
+	size_t n = trace.size()/NB_CAPTEURS;
+	int temps_us[NB_CAPTEURS];
+	int seuils[NB_CAPTEURS];
+	char i;
+	for(i=0; i<NB_CAPTEURS; i++)
+		seuils[i] = seuil;
+
+	//Changements de direction sur un passage
+	Filtre filtre;
+	DecisionBanc decision;
+	int changements = 0, precedente = 0;
+	for(size_t k=0; k<n; k++){
+		for(i=0; i<NB_CAPTEURS; i++)
+			temps_us[i] = trace[NB_CAPTEURS*k+i];
+		filtre.filtre(temps_us);
+		int dir = decision.set_direction(temps_us, seuils);
+		if(dir != precedente)
+			changements++;
+		precedente = dir;
+	}
+
+	//Temps de calcul du filtre seul
+	int somme = 0;
+	clock_t debut = clock();
+	for(int r=0; r<REPETITIONS; r++){
+		Filtre f;
+		for(size_t k=0; k<n; k++){
+			for(i=0; i<NB_CAPTEURS; i++)
+				temps_us[i] = trace[NB_CAPTEURS*k+i];
+			f.filtre(temps_us);
+			somme += temps_us[0];
+		}
+	}
+	double ns = (double)(clock() - debut)*1e9/CLOCKS_PER_SEC/((double)n*REPETITIONS);
+	puits = somme;
+
+	printf("%-22s %8.1f ns/lecture %8d changements de direction\n", nom, ns, changements);
+}
+
+int main(int argc, char **argv){
+	if(argc < 2){
+		fprintf(stderr, "usage : %s trace.txt [seuil]\n", argv[0]);
+		return 1;
+	}
+	std::vector<int> trace;
+	if(!lire_trace(argv[1], trace) || trace.empty()){
+		fprintf(stderr, "trace illisible : %s\n", argv[1]);
+		return 1;
+	}
+	int seuil = argc > 2 ? atoi(argv[2]) : 800;
+	printf("%d lectures, seuil %d\n", (int)trace.size()/NB_CAPTEURS, seuil);
+
+	bench<FiltreAucun>("aucun", trace, seuil);
+	bench<FiltreMedian<3> >("mediane 3", trace, seuil);
+	bench<FiltreMedian<5> >("mediane 5", trace, seuil);
+	bench<FiltreIIR<1> >("IIR 1/2", trace, seuil);
+	bench<FiltreIIR<2> >("IIR 1/4", trace, seuil);
+	bench<FiltreSerie<FiltreMedian<3>, FiltreIIR<1> > >("mediane 3 + IIR 1/2", trace, seuil);
+	return 0;
+}
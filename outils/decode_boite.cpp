@@ -0,0 +1,152 @@
+//Décodage de la boîte noire du robot sur PC
+//
+//Compilation : g++ -O2 -I.. decode_boite.cpp -o decode_boite
+//              (ajouter -DNB_CAPTEURS=n si le robot n'a pas 6 capteurs)
+//Utilisation : ./decode_boite putty.log > boite.csv
+//              ./decode_boite boite.bin > boite.csv
+//
+//Entrée : journal Putty contenant un ou plusieurs vidages "BOITE_NOIRE debut ... fin"
+//ou fichier binaire /local/boite.bin (entête "BNR2")
+//Sortie : un cycle par ligne (CSV, séparateur ';'), dates relatives au dernier cycle,
+//dont la date depuis le démarrage est dans l'entête du vidage
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "boite_noire.h"
+
+static const char *nom_cause(int cause){
+	switch(cause){
+		case GEL_AUCUN: return "aucune";
+		case GEL_PERTE_LIGNE: return "perte de ligne";
+		case GEL_BOUTON: return "bouton";
+		case GEL_DEFAUT: return "defaut materiel";
+		case GEL_ECHEANCE: return "echeance manquee";
+		default: return "inconnue";
+	}
+}
+
+//date_poids_fort : 32 bits de poids fort de la date du dernier cycle
+static void affiche(int numero, int cause, unsigned int date_poids_fort, const std::vector<Enregistrement> &cycles){
+	size_t k;
+	char i;
+	printf("# vidage %d : %d cycles, cause %s", numero, (int)cycles.size(), nom_cause(cause));
+	if(!cycles.empty())
+		printf(", dernier cycle a %.3f s", ((unsigned long long)date_poids_fort << 32 | cycles.back().date_us) / 1e6);
+	printf("\n");
+	printf("date_us");
+	for(i=0; i<NB_CAPTEURS; i++)
+		printf(";t%d", i+1);
+	printf(";direction;confiance;masque;droite;gauche\n");
+	if(cycles.empty())
+		return;
+	unsigned int fin = cycles.back().date_us;
+	for(k=0; k<cycles.size(); k++){
+		const Enregistrement &e = cycles[k];
+		printf("%d", -(int)(fin - e.date_us));
+		for(i=0; i<NB_CAPTEURS; i++)
+			printf(";%u", e.temps_us[i]);
+		printf(";%d;%u;0x%02X;%.3f;%.3f\n", e.direction, e.confiance, (unsigned int)e.masque, e.droite/1000.0, e.gauche/1000.0);
+	}
+}
+
+static int valeur_hex(char c){
+	if(c >= '0' && c <= '9') return c - '0';
+	if(c >= 'A' && c <= 'F') return c - 'A' + 10;
+	if(c >= 'a' && c <= 'f') return c - 'a' + 10;
+	return -1;
+}
+
+//Nombre de capteurs du robot qui a fait le vidage
+static bool capteurs_compatibles(int nombre_capteurs){
+	if(nombre_capteurs != NB_CAPTEURS){
+		fprintf(stderr, "vidage de %d capteurs : recompiler avec -DNB_CAPTEURS=%d\n", nombre_capteurs, nombre_capteurs);
+		return false;
+	}
+	return true;
+}
+
+//Fichier binaire : entête puis enregistrements
+static bool decode_binaire(FILE *f){
+	EnteteBoiteNoire entete;
+	if(fread(&entete, sizeof(entete), 1, f) != 1 || !capteurs_compatibles(entete.nombre_capteurs)
+			|| entete.taille_enregistrement != sizeof(Enregistrement)){
+		fprintf(stderr, "entete invalide\n");
+		return false;
+	}
+	std::vector<Enregistrement> cycles(entete.nombre);
+	if(entete.nombre && fread(&cycles[0], sizeof(Enregistrement), entete.nombre, f) != entete.nombre){
+		fprintf(stderr, "fichier tronque\n");
+		return false;
+	}
+	affiche(1, entete.cause, entete.date_poids_fort, cycles);
+	return true;
+}
+
+//Journal texte : vidages délimités par BOITE_NOIRE debut / fin
+static bool decode_texte(FILE *f){
+	char ligne[256];
+	int numero = 0, cause = 0, taille = 0;
+	unsigned int date_poids_fort = 0;
+	bool dedans = false;
+	std::vector<Enregistrement> cycles;
+	while(fgets(ligne, sizeof(ligne), f)){
+		const char *p = strstr(ligne, "BOITE_NOIRE debut");
+		if(p){
+			int nombre, capteurs;
+			if(sscanf(p, "BOITE_NOIRE debut %d %d %d %d %u", &cause, &nombre, &taille, &capteurs, &date_poids_fort) != 5
+					|| !capteurs_compatibles(capteurs) || taille != (int)sizeof(Enregistrement)){
+				fprintf(stderr, "vidage ignore : format inconnu\n");
+				continue;
+			}
+			cycles.clear();
+			dedans = true;
+			continue;
+		}
+		if(!dedans)
+			continue;
+		if(strstr(ligne, "BOITE_NOIRE fin")){
+			affiche(++numero, cause, date_poids_fort, cycles);
+			dedans = false;
+			continue;
+		}
+		Enregistrement e;
+		unsigned char *octets = (unsigned char *)&e;
+		int n;
+		for(n=0; n<(int)sizeof(e); n++){
+			int h = valeur_hex(ligne[2*n]), l = valeur_hex(ligne[2*n+1]);
+			if(h < 0 || l < 0)
+				break;
+			octets[n] = (unsigned char)(h << 4 | l);
+		}
+		if(n == (int)sizeof(e))
+			cycles.push_back(e);
+	}
+	if(dedans)
+		fprintf(stderr, "dernier vidage incomplet\n");
+	return numero > 0;
+}
+
+int main(int argc, char **argv){
+	if(argc < 2){
+		fprintf(stderr, "usage : %s putty.log|boite.bin\n", argv[0]);
+		return 1;
+	}
+	FILE *f = fopen(argv[1], "rb");
+	if(!f){
+		fprintf(stderr, "fichier illisible : %s\n", argv[1]);
+		return 1;
+	}
+	char magie[4];
+	bool binaire = fread(magie, 1, 4, f) == 4 && memcmp(magie, "BNR2", 4) == 0;
+	rewind(f);
+	bool ok = binaire ? decode_binaire(f) : decode_texte(f);
+	fclose(f);
+	if(!ok){
+		fprintf(stderr, "aucune boite noire trouvee\n");
+		return 1;
+	}
+	return 0;
+}
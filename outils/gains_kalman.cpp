@@ -0,0 +1,66 @@
+//Calcul des gains permanents du filtre de Kalman de position de ligne (estimation.h)
+//
+//Compilation : g++ -O2 gains_kalman.cpp -o gains_kalman
+//Utilisation : ./gains_kalman [bruit_mesure bruit_position bruit_cap bruit_courbure]
+//
+//Modèle (un pas = un cycle de contrôle, positions en pas de capteur) :
+//	position' = position + cap + A*commande
+//	cap'      = cap + courbure + B*commande
+//	courbure' = courbure
+//mesure : position (barycentre des capteurs sur la ligne)
+//Les bruits sont des écarts-types, en pas de capteur (par cycle pour le modèle)
+//L'équation de Riccati est itérée jusqu'à convergence : le gain obtenu est celui
+//vers lequel tend le filtre complet, on l'utilise directement dans le robot (pas de
+//covariance à propager en course). Sortie : gains en Q16, à recopier dans un Reglage
+
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+
+int main(int argc, char **argv){
+	double r = argc > 1 ? atof(argv[1]) : 0.3;
+	double q[3] = {
+		argc > 2 ? atof(argv[2]) : 0.02,
+		argc > 3 ? atof(argv[3]) : 0.002,
+		argc > 4 ? atof(argv[4]) : 0.0002
+	};
+	double F[3][3] = {{1, 1, 0}, {0, 1, 1}, {0, 0, 1}};
+	double P[3][3] = {{1, 0, 0}, {0, 1, 0}, {0, 0, 1}};
+	double K[3] = {0, 0, 0};
+	int n, i, j, k;
+	for(n=0; n<100000; n++){
+		//Prédiction : P = F P F' + Q
+		double FP[3][3], Pp[3][3];
+		for(i=0; i<3; i++)
+			for(j=0; j<3; j++){
+				FP[i][j] = 0;
+				for(k=0; k<3; k++)
+					FP[i][j] += F[i][k]*P[k][j];
+			}
+		for(i=0; i<3; i++)
+			for(j=0; j<3; j++){
+				Pp[i][j] = 0;
+				for(k=0; k<3; k++)
+					Pp[i][j] += FP[i][k]*F[j][k];
+			}
+		for(i=0; i<3; i++)
+			Pp[i][i] += q[i]*q[i];
+		//Mise à jour : K = P H' / (H P H' + R), H = [1 0 0]
+		double s = Pp[0][0] + r*r, ecart = 0;
+		for(i=0; i<3; i++){
+			double g = Pp[i][0]/s;
+			ecart += fabs(g - K[i]);
+			K[i] = g;
+		}
+		for(i=0; i<3; i++)
+			for(j=0; j<3; j++)
+				P[i][j] = Pp[i][j] - K[i]*Pp[0][j];
+		if(ecart < 1e-12)
+			break;
+	}
+	printf("convergence en %d iterations\n", n);
+	printf("K = %.6f %.6f %.6f\n", K[0], K[1], K[2]);
+	printf("GAIN_POSITION = %ld, GAIN_CAP = %ld, GAIN_COURBURE = %ld (Q16)\n",
+		lround(K[0]*65536), lround(K[1]*65536), lround(K[2]*65536));
+	return 0;
+}
@@ -0,0 +1,144 @@
+//Rapport d'occupation de la mémoire à partir du fichier .map de l'édition de liens (armlink)
+//
+//Compilation : g++ -O2 -I.. rapport_memoire.cpp -o rapport_memoire
+//Utilisation : ./rapport_memoire [-detail n] robot.map
+//              (map produite par armlink --map --list=robot.map)
+//
+//Pour chaque région d'exécution de LPC1768.sct : taille utilisée, maximum et taux
+//d'occupation, puis les n plus grosses sections (5 par défaut) avec leur objet
+//La place laissée à la pile et au tas est la fin de la RAM locale après RW_IRAM1,
+//comparée à RESERVE_PILE_TAS (memoire.h)
+//Code de retour 1 si une région déborde ou si la réserve n'est pas tenue
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include "memoire.h"
+
+//Fin de la RAM locale (pile en haut, tas après RW_IRAM1)
+#define FIN_RAM_LOCALE 0x10008000u
+
+struct Section {
+	std::string nom;
+	unsigned int taille;
+};
+
+struct Region {
+	std::string nom;
+	unsigned int base;
+	unsigned int taille;
+	unsigned int maximum;
+	std::vector<Section> sections;
+};
+
+static bool plus_grosse(const Section &a, const Section &b){
+	return a.taille > b.taille;
+}
+
+//"Execution Region RW_IRAM1 (Base: 0x100000c8, Size: 0x00000a10, Max: 0x00005f38, ABSOLUTE)"
+static bool lit_region(const char *ligne, Region &r){
+	char nom[64];
+	const char *p = strstr(ligne, "Execution Region ");
+	if(!p || sscanf(p, "Execution Region %63s (Base: %x, Size: %x, Max: %x", nom, &r.base, &r.taille, &r.maximum) != 4)
+		return false;
+	r.nom = nom;
+	r.sections.clear();
+	return true;
+}
+
+//"0x100000c8   0x00000068   Code   RO   12    RAMCODE   main.o" (adresse de chargement
+//en plus selon la version d'armlink) : la taille précède le type
+static bool lit_section(const char *ligne, Section &s){
+	std::vector<std::string> mots;
+	char mot[256];
+	int n, lu;
+	const char *p = ligne;
+	while(sscanf(p, "%255s%n", mot, &lu) == 1){
+		mots.push_back(mot);
+		p += lu;
+	}
+	if(mots.size() < 3 || mots[0].compare(0, 2, "0x") != 0)
+		return false;
+	for(n=1; n<(int)mots.size(); n++)
+		if(mots[n] == "Code" || mots[n] == "Data" || mots[n] == "Zero" || mots[n] == "PAD")
+			break;
+	if(n == (int)mots.size())
+		return false;
+	s.taille = (unsigned int)strtoul(mots[n-1].c_str(), 0, 16);
+	//Nom de la section et objet : les deux derniers mots (remplissage sinon)
+	s.nom = mots[n] == "PAD" ? "(remplissage)" : mots[mots.size()-2] + " " + mots.back();
+	return true;
+}
+
+int main(int argc, char **argv){
+	int detail = 5, a;
+	const char *nom_map = 0;
+	for(a=1; a<argc; a++){
+		if(!strcmp(argv[a], "-detail") && a+1 < argc)
+			detail = atoi(argv[++a]);
+		else
+			nom_map = argv[a];
+	}
+	if(!nom_map){
+		fprintf(stderr, "usage : %s [-detail n] robot.map\n", argv[0]);
+		return 1;
+	}
+	FILE *f = fopen(nom_map, "r");
+	if(!f){
+		fprintf(stderr, "fichier illisible : %s\n", nom_map);
+		return 1;
+	}
+
+	std::vector<Region> regions;
+	char ligne[512];
+	while(fgets(ligne, sizeof(ligne), f)){
+		Region r;
+		Section s;
+		if(lit_region(ligne, r))
+			regions.push_back(r);
+		else if(!regions.empty() && lit_section(ligne, s))
+			regions.back().sections.push_back(s);
+	}
+	fclose(f);
+	if(regions.empty()){
+		fprintf(stderr, "aucune region d'execution : map d'armlink attendue\n");
+		return 1;
+	}
+
+	bool ok = true;
+	size_t k, i;
+	printf("%-12s %10s %10s %10s %7s\n", "region", "base", "utilise", "maximum", "occupe");
+	for(k=0; k<regions.size(); k++){
+		const Region &r = regions[k];
+		printf("%-12s 0x%08X %10u %10u %6.1f%%%s\n", r.nom.c_str(), r.base, r.taille, r.maximum,
+			r.maximum ? 100.0*r.taille/r.maximum : 0.0, r.taille > r.maximum ? "  DEBORDE" : "");
+		if(r.taille > r.maximum)
+			ok = false;
+	}
+
+	//Pile et tas : de la fin de RW_IRAM1 à la fin de la RAM locale
+	for(k=0; k<regions.size(); k++)
+		if(regions[k].nom == "RW_IRAM1"){
+			unsigned int fin = regions[k].base + regions[k].taille;
+			int libre = (int)(FIN_RAM_LOCALE - fin);
+			printf("\npile et tas : %d octets (reserve %d)%s\n", libre, RESERVE_PILE_TAS,
+				libre < RESERVE_PILE_TAS ? "  INSUFFISANT" : "");
+			if(libre < RESERVE_PILE_TAS)
+				ok = false;
+		}
+
+	for(k=0; k<regions.size() && detail > 0; k++){
+		std::vector<Section> sections = regions[k].sections;
+		if(sections.empty())
+			continue;
+		std::sort(sections.begin(), sections.end(), plus_grosse);
+		printf("\n%s :\n", regions[k].nom.c_str());
+		for(i=0; i<sections.size() && (int)i<detail; i++)
+			printf("  %8u  %s\n", sections[i].taille, sections[i].nom.c_str());
+	}
+	return ok ? 0 : 1;
+}
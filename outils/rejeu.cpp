@@ -0,0 +1,289 @@
+//Rejeu sur PC d'une trace des capteurs à travers le calcul du robot
+//
+//Compilation : g++ -O2 -I.. rejeu.cpp -o rejeu
+//              (ajouter -DNB_CAPTEURS=n si le robot n'a pas 6 capteurs)
+//Utilisation : ./rejeu [-config 1|2|3|4|5|6] [-seuil S] [-sortie sorties.csv] [-reference ref.csv] trace
+//
+//Entrée : capture binaire de la liaison série (CAPTURE_TRACE, entête "TRC1" puis une
+//trame par cycle, voir trace.h), éventuellement mêlée aux messages texte du robot,
+//ou fichier texte avec les NB_CAPTEURS temps d'une lecture par ligne (pas d'entête : -seuil)
+//Chaque lecture passe dans Controle<ConfigControleX>, le même code que dans le robot
+//(filtre, décision, seuils, vitesses). Les sorties de chaque cycle sont écrites en CSV
+//(-sortie) et comparées à un rejeu précédent (-reference) : la première différence est
+//affichée, ce qui permet de vérifier qu'une modification du calcul ne change rien
+//ou de voir exactement où elle change le comportement.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <string>
+#include <vector>
+
+#include "trace.h"
+#include "controle.h"
+#include "configurations.h"
+
+//Calibrage lu dans l'entête de la trace (ou donné sur la ligne de commande)
+class CalibrageRejeu {
+public:
+	explicit CalibrageRejeu(int seuil) : seuil_(seuil) {
+		int i;
+		for(i=0; i<NB_CAPTEURS; i++)
+			noir[i] = blanc[i] = seuil;
+	}
+	explicit CalibrageRejeu(const EnteteTrace &entete) : seuil_(entete.seuil) {
+		int i;
+		for(i=0; i<NB_CAPTEURS; i++){
+			noir[i] = entete.noir[i];
+			blanc[i] = entete.blanc[i];
+		}
+	}
+
+	int seuil() const { return seuil_; }
+	int niveau_noir(int i) const { return noir[i]; }
+	int niveau_blanc(int i) const { return blanc[i]; }
+
+private:
+	int seuil_;
+	int noir[NB_CAPTEURS];
+	int blanc[NB_CAPTEURS];
+};
+
+//Lecture à rejouer
+struct Lecture {
+	int numero;
+	int temps_us[NB_CAPTEURS];
+};
+
+static std::vector<unsigned char> lire_fichier(const char *nom){
+	std::vector<unsigned char> octets;
+	FILE *f = fopen(nom, "rb");
+	if(!f)
+		return octets;
+	unsigned char tampon[4096];
+	size_t n;
+	while((n = fread(tampon, 1, sizeof(tampon), f)) > 0)
+		octets.insert(octets.end(), tampon, tampon + n);
+	fclose(f);
+	return octets;
+}
+
+//Capture binaire : trames reconnues à l'octet de synchro et à la somme de contrôle,
+//le reste (messages texte, trames abîmées) est sauté octet par octet
+//Les trames perdues sont repérées grâce au numéro de trame
+static bool decode_binaire(const std::vector<unsigned char> &octets, size_t debut,
+		EnteteTrace &entete, std::vector<Lecture> &lectures, int &perdues, int &rejetes){
+	size_t p = debut;
+	int precedent = -1;
+	char i;
+	memcpy(&entete, &octets[p], sizeof(entete));
+	p += sizeof(entete);
+	if(entete.nombre_capteurs != NB_CAPTEURS){
+		fprintf(stderr, "trace de %d capteurs : recompiler avec -DNB_CAPTEURS=%d\n", entete.nombre_capteurs, entete.nombre_capteurs);
+		return false;
+	}
+	perdues = rejetes = 0;
+	while(p + sizeof(TrameTrace) <= octets.size()){
+		TrameTrace trame;
+		memcpy(&trame, &octets[p], sizeof(trame));
+		if(trame.synchro != SYNCHRO_TRACE || trame.somme != somme_trace(trame)){
+			p++;
+			rejetes++;
+			continue;
+		}
+		if(precedent >= 0)
+			perdues += (unsigned char)(trame.numero - precedent - 1);
+		precedent = trame.numero;
+		Lecture l;
+		l.numero = (int)lectures.size() + perdues;
+		for(i=0; i<NB_CAPTEURS; i++)
+			l.temps_us[i] = trame.temps_us[i];
+		lectures.push_back(l);
+		p += sizeof(trame);
+	}
+	return !lectures.empty();
+}
+
+//Fichier texte : NB_CAPTEURS temps par ligne
+static bool decode_texte(const std::vector<unsigned char> &octets, std::vector<Lecture> &lectures){
+	std::string texte(octets.begin(), octets.end());
+	const char *c = texte.c_str();
+	char *fin;
+	int temps[NB_CAPTEURS], n = 0;
+	for(long v = strtol(c, &fin, 10); fin != c; v = strtol(c, &fin, 10)){
+		temps[n++] = (int)v;
+		c = fin;
+		if(n == NB_CAPTEURS){
+			Lecture l;
+			l.numero = (int)lectures.size();
+			memcpy(l.temps_us, temps, sizeof(temps));
+			lectures.push_back(l);
+			n = 0;
+		}
+	}
+	return !lectures.empty();
+}
+
+//Hachage FNV-1a des sorties (empreinte rapide d'un rejeu)
+static unsigned int fnv1a(unsigned int h, const char *texte){
+	while(*texte){
+		h ^= (unsigned char)*texte++;
+		h *= 16777619u;
+	}
+	return h;
+}
+
+template<class Config>
+static int rejoue(const std::vector<Lecture> &lectures, const CalibrageRejeu &calibrage,
+		FILE *sortie, FILE *reference){
+	Controle<Config> controle;
+	std::vector<std::string> lignes(lectures.size());
+	size_t k;
+	char i;
+	controle.init(calibrage);
+
+	//Rejeu seul, pour la mesure du temps de calcul
+	clock_t debut = clock();
+	std::vector<int> directions(lectures.size());
+	for(k=0; k<lectures.size(); k++){
+		int temps_us[NB_CAPTEURS];
+		memcpy(temps_us, lectures[k].temps_us, sizeof(temps_us));
+		directions[k] = controle.cycle(temps_us);
+	}
+	double duree = (double)(clock() - debut)/CLOCKS_PER_SEC;
+
+	//Second rejeu à partir du même état initial, avec les sorties de chaque cycle
+	Controle<Config> controle_sorties;
+	controle_sorties.init(calibrage);
+	unsigned int empreinte = 2166136261u;
+	for(k=0; k<lectures.size(); k++){
+		int temps_us[NB_CAPTEURS];
+		char ligne[256];
+		int n;
+		memcpy(temps_us, lectures[k].temps_us, sizeof(temps_us));
+		controle_sorties.cycle(temps_us);
+		n = sprintf(ligne, "%d;%d;%d;0x%02X;%.3f;%.3f", lectures[k].numero,
+			controle_sorties.decision().direction_courante(), controle_sorties.decision().confiance(),
+			controle_sorties.decision().masque(), controle_sorties.pilotage().droite()/1000.0,
+			controle_sorties.pilotage().gauche()/1000.0);
+		for(i=0; i<NB_CAPTEURS; i++)
+			n += sprintf(ligne + n, ";%d", controle_sorties.seuil().seuils()[i]);
+		lignes[k] = ligne;
+		empreinte = fnv1a(empreinte, ligne);
+	}
+
+	if(sortie){
+		fprintf(sortie, "numero;direction;confiance;masque;droite;gauche");
+		for(i=0; i<NB_CAPTEURS; i++)
+			fprintf(sortie, ";s%d", i+1);
+		fprintf(sortie, "\n");
+		for(k=0; k<lignes.size(); k++)
+			fprintf(sortie, "%s\n", lignes[k].c_str());
+	}
+
+	printf("%d cycles rejoues, %.0f cycles/s, empreinte %08X\n", (int)lectures.size(),
+		duree > 0 ? lectures.size()/duree : 0.0, empreinte);
+
+	if(!reference)
+		return 0;
+	char ligne[256];
+	//Première ligne : en-têtes des colonnes
+	if(!fgets(ligne, sizeof(ligne), reference)){
+		printf("reference vide\n");
+		return 1;
+	}
+	for(k=0; k<lignes.size(); k++){
+		if(!fgets(ligne, sizeof(ligne), reference)){
+			printf("reference plus courte : %d cycles\n", (int)k);
+			return 1;
+		}
+		ligne[strcspn(ligne, "\r\n")] = 0;
+		if(lignes[k] != ligne){
+			printf("premiere difference au cycle %d (lecture %d) :\n", (int)k, lectures[k].numero);
+			printf("  temps     :");
+			for(i=0; i<NB_CAPTEURS; i++)
+				printf(" %d", lectures[k].temps_us[i]);
+			printf("\n  reference : %s\n  rejeu     : %s\n", ligne, lignes[k].c_str());
+			return 1;
+		}
+	}
+	if(fgets(ligne, sizeof(ligne), reference)){
+		printf("reference plus longue que le rejeu\n");
+		return 1;
+	}
+	printf("identique a la reference\n");
+	return 0;
+}
+
+int main(int argc, char **argv){
+	int config = 2, seuil = 800, a;
+	const char *nom = 0, *nom_sortie = 0, *nom_reference = 0;
+	for(a=1; a<argc; a++){
+		if(!strcmp(argv[a], "-config") && a+1 < argc)
+			config = atoi(argv[++a]);
+		else if(!strcmp(argv[a], "-seuil") && a+1 < argc)
+			seuil = atoi(argv[++a]);
+		else if(!strcmp(argv[a], "-sortie") && a+1 < argc)
+			nom_sortie = argv[++a];
+		else if(!strcmp(argv[a], "-reference") && a+1 < argc)
+			nom_reference = argv[++a];
+		else
+			nom = argv[a];
+	}
+	if(!nom || config < 1 || config > 6){
+		fprintf(stderr, "usage : %s [-config 1|2|3|4|5|6] [-seuil S] [-sortie sorties.csv] [-reference ref.csv] trace\n", argv[0]);
+		return 1;
+	}
+
+	std::vector<unsigned char> octets = lire_fichier(nom);
+	std::vector<Lecture> lectures;
+	CalibrageRejeu calibrage(seuil);
+	size_t p;
+	for(p=0; p + sizeof(EnteteTrace) <= octets.size(); p++)
+		if(!memcmp(&octets[p], "TRC1", 4))
+			break;
+	if(p + sizeof(EnteteTrace) <= octets.size()){
+		EnteteTrace entete;
+		int perdues, rejetes;
+		if(!decode_binaire(octets, p, entete, lectures, perdues, rejetes)){
+			fprintf(stderr, "aucune trame dans la trace\n");
+			return 1;
+		}
+		calibrage = CalibrageRejeu(entete);
+		printf("trace binaire : seuil %d, %d trames perdues, %d octets ignores\n", entete.seuil, perdues, rejetes);
+	}
+	else if(!decode_texte(octets, lectures)){
+		fprintf(stderr, "trace illisible : %s\n", nom);
+		return 1;
+	}
+
+	FILE *sortie = 0, *reference = 0;
+	if(nom_sortie && !(sortie = fopen(nom_sortie, "w"))){
+		fprintf(stderr, "fichier illisible : %s\n", nom_sortie);
+		return 1;
+	}
+	if(nom_reference && !(reference = fopen(nom_reference, "r"))){
+		fprintf(stderr, "fichier illisible : %s\n", nom_reference);
+		return 1;
+	}
+	int resultat;
+	switch(config){
+#if NB_CAPTEURS == 6
+		case 1: resultat = rejoue<ConfigControle1>(lectures, calibrage, sortie, reference); break;
+		case 2: resultat = rejoue<ConfigControle2>(lectures, calibrage, sortie, reference); break;
+		case 6: resultat = rejoue<ConfigControle6>(lectures, calibrage, sortie, reference); break;
+#endif
+		case 3: resultat = rejoue<ConfigControle3>(lectures, calibrage, sortie, reference); break;
+		case 4: resultat = rejoue<ConfigControle4>(lectures, calibrage, sortie, reference); break;
+		case 5: resultat = rejoue<ConfigControle5>(lectures, calibrage, sortie, reference); break;
+		default:
+			fprintf(stderr, "configuration %d : 6 capteurs uniquement\n", config);
+			resultat = 1;
+	}
+	if(sortie)
+		fclose(sortie);
+	if(reference)
+		fclose(reference);
+	return resultat;
+}
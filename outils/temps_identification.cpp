@@ -0,0 +1,120 @@
+//Temps de l'identification des moteurs face à l'échéance de la surveillance, sur PC
+//
+//Compilation : g++ -O2 -I.. temps_identification.cpp -o temps_identification
+//Utilisation : ./temps_identification
+//
+//Deux moteurs simulés (zone morte, gain, premier ordre) mesurés par les codeurs des roues
+//(essais de durée fixe : chaque échelon garde jusqu'à POINTS points, le pire cas de
+//l'ajustement) passent par IdentificationMoteurs, le même code que dans le robot
+//Les expf d'IdentificationMoteurs sont comptés : un par point et par écart de la section
+//dorée, c'est l'essentiel du calcul. Le pire ajustement (termine_echelon()) est estimé sur
+//le LPC1768 à partir de son nombre d'expf ; il dépasse de loin ECHEANCE_CYCLE_US +
+//DELAI_COUPURE_MS : cycle() ne doit faire que mesurer, l'ajustement se fait hors
+//surveillance (robot.h). Les temps sur PC sont donnés pour information
+//Échec si un cycle() appelle expf (ajustement revenu dans le cycle) ou si les
+//caractéristiques retrouvées sont loin de celles simulées
+
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <math.h>
+
+//Compteur des expf d'identification.h (math.h déjà inclus : son include est sans effet)
+static long appels_expf = 0;
+
+static float expf_compte(float x){
+	appels_expf++;
+	return expf(x);
+}
+
+#define expf expf_compte
+#include "identification.h"
+#undef expf
+
+//Horloge du LPC1768 et coût estimé d'un point de ecart() (expf, division et produits
+//en flottant logiciel) : ordre de grandeur, à mesurer sur la cible
+#define FREQUENCE_CIBLE_HZ 96000000.0
+#define CYCLES_CIBLE_POINT 1000.0
+
+//Moteur simulé : vitesse (Q8 par cycle) en premier ordre vers gain*(pwm - zone morte)
+struct MoteurSimule {
+	double zone_morte, gain, tau, vitesse, position;
+
+	void cycle(int pwm){
+		double cible = pwm > zone_morte ? gain*(pwm - zone_morte) : 0;
+		vitesse += (cible - vitesse)/tau;
+		position += vitesse;
+	}
+};
+
+static double secondes(){
+	return (double)clock()/CLOCKS_PER_SEC;
+}
+
+int main(){
+	static IdentificationMoteurs<false> identification;
+	//Moteur droit, moteur gauche : zone morte (‰), gain (Q8 par cycle et par ‰), tau (cycles)
+	MoteurSimule moteurs[2] = {{80, 0.05, 20, 0, 0}, {95, 0.045, 30, 0, 0}};
+	double pire_cycle = 0, pire_ajustement = 0, t;
+	int pwm_droite, pwm_gauche, pire_points = 0, ajustements = 0, m;
+	long cycles = 0, expf_cycles = 0, pire_expf = 0, avant;
+
+	while(!identification.terminee() && cycles < 10000000){
+		avant = appels_expf;
+		t = secondes();
+		identification.cycle(true, (int)moteurs[MOTEUR_DROIT].position, (int)moteurs[MOTEUR_GAUCHE].position, pwm_droite, pwm_gauche);
+		t = secondes() - t;
+		if(t > pire_cycle)
+			pire_cycle = t;
+		expf_cycles += appels_expf - avant;
+		moteurs[MOTEUR_DROIT].cycle(pwm_droite);
+		moteurs[MOTEUR_GAUCHE].cycle(pwm_gauche);
+		cycles++;
+		if(!identification.analyse_en_attente())
+			continue;
+		//Robot arrêté pendant l'ajustement
+		if(identification.points() > pire_points)
+			pire_points = identification.points();
+		avant = appels_expf;
+		t = secondes();
+		identification.termine_echelon();
+		t = secondes() - t;
+		if(t > pire_ajustement)
+			pire_ajustement = t;
+		if(appels_expf - avant > pire_expf)
+			pire_expf = appels_expf - avant;
+		ajustements++;
+		for(m=0; m<2; m++)
+			moteurs[m].vitesse = 0;
+	}
+
+	double cible_ms = pire_expf*CYCLES_CIBLE_POINT/FREQUENCE_CIBLE_HZ*1000;
+	double echeance_ms = ECHEANCE_CYCLE_US/1000.0 + DELAI_COUPURE_MS;
+	printf("%ld cycles, %d ajustements (jusqu'a %d points)\n", cycles, ajustements, pire_points);
+	printf("Pire cycle() sur PC      : %8.1f us, %ld expf en tout\n", pire_cycle*1e6, expf_cycles);
+	printf("Pire ajustement sur PC   : %8.1f us, %ld expf\n", pire_ajustement*1e6, pire_expf);
+	printf("Ajustement sur LPC1768   : %8.1f ms estimees, echeance %.1f ms%s\n", cible_ms,
+		echeance_ms, cible_ms > echeance_ms ? " : hors surveillance" : "");
+
+	int erreurs = 0;
+	if(!identification.reussie()){
+		printf("ERREUR : identification echouee\n");
+		return 1;
+	}
+	if(ajustements == 0 || expf_cycles != 0){
+		printf("ERREUR : ajustement dans cycle()\n");
+		erreurs++;
+	}
+	for(m=0; m<2; m++){
+		const CaracteristiqueMoteur &c = identification.caracteristique(m);
+		double gain = c.gain/65536.0, tau = c.constante_temps/(double)PERIODE_CONTROLE_US;
+		printf("Moteur %s : zone morte %d (%g), gain %.4f (%g), tau %.1f (%g) cycles\n", m == MOTEUR_DROIT ? "droit " : "gauche",
+			c.zone_morte, moteurs[m].zone_morte, gain, moteurs[m].gain, tau, moteurs[m].tau);
+		if(abs(c.zone_morte - (int)moteurs[m].zone_morte) > 10 || gain < moteurs[m].gain*0.9 || gain > moteurs[m].gain*1.1
+			|| tau < moteurs[m].tau*0.8 || tau > moteurs[m].tau*1.2){
+			printf("ERREUR : moteur %d mal identifie\n", m);
+			erreurs++;
+		}
+	}
+	return erreurs ? 1 : 0;
+}
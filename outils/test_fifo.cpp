@@ -0,0 +1,174 @@
+//Essai de FileSPSC (fifo.h) sur PC avec un producteur et un consommateur sur deux threads
+//
+//Compilation : g++ -O2 -pthread -I.. test_fifo.cpp -o test_fifo
+//              (ajouter -DNB_CAPTEURS=n si le robot n'a pas 6 capteurs)
+//Utilisation : ./test_fifo [nombre_de_trames]
+//
+//Même file que celle des trames de l'acquisition (FileSPSC<Trame, 4>, capteurs.h) : la
+//trame est recopiée ici, capteurs.h dépend de mbed
+//Sur un seul thread : la file accepte exactement TAILLE éléments, refuse le suivant
+//(pleine), les rend dans l'ordre puis se dit vide ; retire_dernier() garde le plus récent
+//Sur deux threads : le producteur numérote les trames (tous les temps d'une trame
+//dérivent de son numéro) et réessaie quand la file est pleine, le consommateur vérifie
+//que chaque trame arrive une fois, dans l'ordre et entière (aucune écriture à moitié vue)
+//Les deux côtés attendent en boucle quand la file est pleine ou vide (la main est laissée
+//de temps en temps s'il n'y a qu'un processeur) : les deux cas doivent se produire
+
+#include <cstdio>
+#include <cstdlib>
+#include <pthread.h>
+#include <sched.h>
+
+#include "parametres.h"
+#include "fifo.h"
+
+//Copie de la trame de capteurs.h
+struct Trame {
+	int temps_us[NB_CAPTEURS];
+};
+
+enum { TAILLE = 4 };
+typedef FileSPSC<Trame, TAILLE> FileTrames;
+
+//Trame numéro n : chaque temps en dépend, une trame mélangée avec une autre se voit
+static void remplit(Trame &trame, unsigned int n){
+	int i;
+	for(i=0; i<NB_CAPTEURS; i++)
+		trame.temps_us[i] = (int)(n*NB_CAPTEURS + i);
+}
+
+static bool numero(const Trame &trame, unsigned int &n){
+	int i;
+	n = (unsigned int)trame.temps_us[0] / NB_CAPTEURS;
+	for(i=0; i<NB_CAPTEURS; i++)
+		if(trame.temps_us[i] != (int)(n*NB_CAPTEURS + i))
+			return false;
+	return true;
+}
+
+//Bornes de nombre() vues de chaque côté
+static bool nombre_valide(const FileTrames &file){
+	int n = file.nombre();
+	return n >= 0 && n <= TAILLE;
+}
+
+static int essai_seul(){
+	FileTrames file;
+	Trame trame;
+	unsigned int n, i;
+	int erreurs = 0;
+	if(!file.vide() || file.retire(trame)){
+		printf("ERREUR : file neuve pas vide\n");
+		erreurs++;
+	}
+	for(i=0; i<TAILLE; i++){
+		remplit(trame, i);
+		if(!file.ajoute(trame)){
+			printf("ERREUR : trame %u refusee avant TAILLE\n", i);
+			erreurs++;
+		}
+	}
+	remplit(trame, TAILLE);
+	if(!file.pleine() || file.nombre() != TAILLE || file.ajoute(trame)){
+		printf("ERREUR : file pleine non detectee\n");
+		erreurs++;
+	}
+	for(i=0; i<TAILLE; i++)
+		if(!file.retire(trame) || !numero(trame, n) || n != i){
+			printf("ERREUR : trame %u mal rendue\n", i);
+			erreurs++;
+		}
+	if(!file.vide() || file.nombre() != 0 || file.retire(trame)){
+		printf("ERREUR : file vide non detectee\n");
+		erreurs++;
+	}
+	//Indices au-delà de TAILLE (la file a déjà tourné) : seule la plus récente est gardée
+	for(i=0; i<3; i++){
+		remplit(trame, 100 + i);
+		file.ajoute(trame);
+	}
+	if(!file.retire_dernier(trame) || !numero(trame, n) || n != 102 || !file.vide()){
+		printf("ERREUR : retire_dernier\n");
+		erreurs++;
+	}
+	return erreurs;
+}
+
+//Essai sur deux threads
+static FileTrames file;
+//Attentes actives avant de laisser la main à l'autre thread
+enum { ATTENTES_ACTIVES = 64 };
+static unsigned int total;
+static unsigned long pleine, invalide_producteur;
+
+static void *producteur(void *){
+	Trame trame;
+	unsigned int i = 0;
+	while(i < total){
+		remplit(trame, i);
+		if(file.ajoute(trame))
+			i++;
+		else if(++pleine % ATTENTES_ACTIVES == 0)
+			sched_yield();
+		if(!nombre_valide(file))
+			invalide_producteur++;
+	}
+	return 0;
+}
+
+int main(int argc, char **argv){
+	total = argc > 1 ? (unsigned int)strtoul(argv[1], 0, 10) : 10000000;
+	int erreurs = essai_seul();
+
+	pthread_t thread;
+	unsigned long vide = 0, invalide = 0, mauvaises = 0, n_erreurs = 0;
+	unsigned int attendue = 0, n;
+	Trame trame;
+	if(pthread_create(&thread, 0, producteur, 0)){
+		printf("ERREUR : pthread_create\n");
+		return 1;
+	}
+	while(attendue < total){
+		if(!file.retire(trame)){
+			if(++vide % ATTENTES_ACTIVES == 0)
+				sched_yield();
+			continue;
+		}
+		if(!nombre_valide(file))
+			invalide++;
+		if(!numero(trame, n)){
+			//Trame lue pendant son écriture
+			if(mauvaises++ < 10)
+				printf("ERREUR : trame %u incoherente\n", attendue);
+			attendue++;
+			continue;
+		}
+		//Trame perdue (n plus grand), dupliquée ou dans le désordre (n plus petit)
+		if(n != attendue){
+			if(n_erreurs++ < 10)
+				printf("ERREUR : trame %u recue au lieu de %u\n", n, attendue);
+			if(n < attendue)
+				continue;
+			attendue = n;
+		}
+		attendue++;
+	}
+	pthread_join(thread, 0);
+	if(file.retire(trame) || !file.vide()){
+		printf("ERREUR : trame en trop apres la derniere\n");
+		erreurs++;
+	}
+
+	printf("%u trames de %d octets, file de %d : pleine %lu fois, vide %lu fois\n", total, (int)sizeof(Trame), (int)TAILLE, pleine, vide);
+	erreurs += (int)(mauvaises + n_erreurs);
+	if(invalide || invalide_producteur){
+		printf("ERREUR : nombre() hors de [0, %d] (%lu fois)\n", (int)TAILLE, invalide + invalide_producteur);
+		erreurs++;
+	}
+	if(total >= 100000 && (pleine == 0 || vide == 0)){
+		printf("ERREUR : file jamais %s pendant l'essai\n", pleine == 0 ? "pleine" : "vide");
+		erreurs++;
+	}
+	printf(erreurs ? "ECHEC : %d erreurs\n" : "ok\n", erreurs);
+	return erreurs ? 1 : 0;
+}
@@ -0,0 +1,115 @@
+//Vérification sur PC que le cycle de contrôle n'utilise aucun flottant
+//
+//Compilation : g++ -O2 -mgeneral-regs-only -I.. verifie_entiers.cpp -o verifie_entiers
+//              (ajouter -DNB_CAPTEURS=n si le robot n'a pas 6 capteurs)
+//Utilisation : ./verifie_entiers
+//
+//-mgeneral-regs-only interdit à gcc les registres flottants : la compilation échoue
+//("SSE register return with SSE disabled"...) dès qu'un float ou un double entre dans
+//le code compilé ici, c'est-à-dire le cycle de chaque configuration (Controle, le même
+//code que dans le robot), l'essai de réglage en relais et la linéarisation des moteurs
+//Le matériel (Moteurs, PWM) n'est pas compilable sur PC : il ne fait que recopier
+//la PWM de LinearisationMoteurs dans les registres MR3 et MR4
+//Le programme compilé rejoue ensuite une ligne qui balaie la barrette dans chaque
+//configuration et vérifie que les vitesses restent dans la période PWM
+
+#include <cstdio>
+
+#include "controle.h"
+#include "configurations.h"
+#include "identification.h"
+
+//Code du cycle compilé en entier pour chaque configuration
+#if NB_CAPTEURS == 6
+template class Controle<ConfigControle1>;
+template class Controle<ConfigControle2>;
+template class Controle<ConfigControle6>;
+#endif
+template class Controle<ConfigControle3>;
+template class Controle<ConfigControle4>;
+template class Controle<ConfigControle5>;
+
+//Calibrage fixe : noir à 1000µs, blanc à 200µs
+class CalibrageVerification {
+public:
+	int seuil() const { return 600; }
+	int niveau_noir(int) const { return 1000; }
+	int niveau_blanc(int) const { return 200; }
+};
+
+//Temps des capteurs pour une ligne à la position donnée (Q8, pas de capteur)
+static void temps_ligne(int position_q8, int temps_us[NB_CAPTEURS]){
+	char i;
+	for(i=0; i<NB_CAPTEURS; i++){
+		int ecart = (2*i - (NB_CAPTEURS-1)) * 128 - position_q8;
+		if(ecart < 0)
+			ecart = -ecart;
+		temps_us[i] = ecart < 256 ? 200 + 800*ecart/256 : 1000;
+	}
+}
+
+template<class Config>
+static bool verifie(const char *nom){
+	Controle<Config> controle;
+	CalibrageVerification calibrage;
+	int k, temps_us[NB_CAPTEURS];
+	bool ok = true;
+	controle.init(calibrage);
+	for(k=0; k<4000; k++){
+		//Aller-retour de la ligne d'un bord à l'autre de la barrette
+		int phase = k % 400, position = ((phase < 200 ? phase : 400 - phase) - 100) * (NB_CAPTEURS << 8) / 200;
+		temps_ligne(position, temps_us);
+		controle.cycle(temps_us);
+		int droite = controle.pilotage().droite(), gauche = controle.pilotage().gauche();
+		if(droite < 0 || droite > 1000 || gauche < 0 || gauche > 1000)
+			ok = false;
+	}
+	printf("%s : %s\n", nom, ok ? "ok" : "vitesses hors de la periode PWM");
+	return ok;
+}
+
+//Essai en relais sur une ligne qui oscille : gains entiers
+static bool verifie_reglage(){
+	Controle<ConfigControle4> controle;
+	CalibrageVerification calibrage;
+	int k, temps_us[NB_CAPTEURS];
+	controle.init(calibrage);
+	controle.pilotage().demarre_reglage();
+	for(k=0; k<ReglageRelais::DUREE_MAX && controle.pilotage().reglage_en_cours(); k++){
+		int phase = k % 60, position = ((phase < 30 ? phase : 60 - phase) - 15) * 256 / 10;
+		temps_ligne(position, temps_us);
+		controle.cycle(temps_us);
+	}
+	const ReglageRelais &essai = controle.pilotage().reglage();
+	printf("reglage : etat %d, Tu %d cycles, KP %d KD %d\n", essai.etat(), essai.periode(), essai.kp(), essai.kd());
+	return essai.etat() != REGLAGE_EN_COURS;
+}
+
+static bool verifie_linearisation(){
+	CaracteristiqueMoteur droite = {150, 300, 40000}, gauche = {120, 280, 50000};
+	LinearisationMoteurs linearisation;
+	int v;
+	bool ok = linearisation.regle(droite, gauche);
+	for(v=0; v<=1000 && ok; v+=10){
+		int d = linearisation.pwm(MOTEUR_DROIT, v), g = linearisation.pwm(MOTEUR_GAUCHE, v);
+		if(d < 0 || d > 1000 || g < 0 || g > 1000 || (v > 0 && (d < droite.zone_morte || g < gauche.zone_morte)))
+			ok = false;
+	}
+	printf("linearisation : %s\n", ok ? "ok" : "PWM hors zone");
+	return ok;
+}
+
+int main(){
+	bool ok = true;
+#if NB_CAPTEURS == 6
+	ok = verifie<ConfigControle1>("config 1") && ok;
+	ok = verifie<ConfigControle2>("config 2") && ok;
+	ok = verifie<ConfigControle6>("config 6") && ok;
+#endif
+	ok = verifie<ConfigControle3>("config 3") && ok;
+	ok = verifie<ConfigControle4>("config 4") && ok;
+	ok = verifie<ConfigControle5>("config 5") && ok;
+	ok = verifie_reglage() && ok;
+	ok = verifie_linearisation() && ok;
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,74 @@
+#ifndef PARAMETRES_H
+#define PARAMETRES_H
+
+//Paramètres communs à toutes les configurations du robot
+
+//Nombre de capteurs de la barrette (32 au plus), leurs broches sont dans capteurs.h
+//Les formats de la boîte noire et des traces en dépendent : les outils sur PC
+//se compilent avec la même valeur (-DNB_CAPTEURS=8)
+#ifndef NB_CAPTEURS
+#define NB_CAPTEURS 6
+#endif
+
+//Période des PWM des moteurs
+#define PERIODE_PWM_US 1000 //1ms
+//Période de la boucle de contrôle (tick du TIMER1, cadence.h)
+#define PERIODE_CONTROLE_US 2000 //2ms
+//Période d'affichage du taux d'inactivité CPU
+#define PERIODE_RAPPORT_US 2000000 //2s
+//Vidage de la boîte noire aussi dans /local/boite.bin (LocalFileSystem)
+//Le microcontrôleur ne dort plus : sleep() couperait l'accès au LocalFileSystem
+#define BOITE_NOIRE_FICHIER 0
+//Rejet de la lumière ambiante (acquisition en tâche de fond) : une trame sur REJET_AMBIANT
+//est mesurée émetteurs IR éteints, LEDON des capteurs câblé sur p21
+//0 -> émetteurs toujours allumés (LEDON non câblé)
+#define REJET_AMBIANT 0
+//Charge des capteurs et fenêtre de décharge réglées en course (gamme.h, acquisition en tâche de fond)
+//0 -> charge de 10µs et fenêtre de 5ms fixes
+#define GAMME_AUTO 0
+//Vitesse de la liaison série (Putty)
+#define VITESSE_SERIE 9600
+//Envoi des temps bruts de chaque cycle en binaire sur la liaison série (outils/rejeu.cpp)
+//16 octets par cycle : il faut au moins 115200 bauds pour PERIODE_CONTROLE_US = 2ms
+#define CAPTURE_TRACE 0
+//Réglage automatique du correcteur PD (CONFIG_ROBOT 4) : départ avec le bouton maintenu 1s
+//-> essai en relais au début de la course, gains sauvegardés en flash pour les courses suivantes
+#define AUTO_REGLAGE 0
+//Identification des moteurs (identification.h) : le départ lance les essais à la place de la course,
+//robot posé sur la ligne ; zone morte, gain et constante de temps affichés et sauvegardés en flash
+#define IDENTIFICATION_MOTEURS 0
+//Mesure par codeurs sur les roues pendant l'identification (broches dans codeurs.h)
+//0 -> mesure par la position de la ligne sous la barrette
+#define CODEURS_ROUES 0
+//Linéarisation PWM -> vitesse des moteurs avec la dernière identification sauvegardée
+#define COMPENSATION_MOTEURS 0
+//Acquisition, calcul du cycle et commande des moteurs exécutés depuis la RAM locale
+//(EN_RAM, memoire.h) ; 0 -> tout en flash, pour comparer avec MESURE_CYCLES
+#define CODE_EN_RAM 1
+//Durée du calcul de chaque cycle en cycles processeur (DWT), affichée avec le taux d'inactivité
+#define MESURE_CYCLES 0
+//Budget du filtre sur la cible (µs), vérifié à chaque cycle avec MESURE_CYCLES :
+//les dépassements sont comptés et signalés dans le rapport
+#define BUDGET_FILTRE_US 20
+//Surveillance de la boucle de contrôle (surveillance.h) : en course, un cycle doit se terminer
+//au plus ECHEANCE_CYCLE_US après le précédent (plus long qu'une trame de l'acquisition
+//en tâche de fond, fenêtre de décharge comprise) ; DELAI_COUPURE_MS plus tard, E1/E2 sont coupées
+#define ECHEANCE_CYCLE_US 10000 //10ms
+#define DELAI_COUPURE_MS 5
+//Chien de garde matériel : redémarrage si la surveillance ne tourne plus
+//(plus long que l'effacement de la flash, 100 ms interruptions masquées)
+#define DELAI_CHIEN_DE_GARDE_MS 250
+//Priorités d'interruption (priorites.h) : acquisition et tick du cycle avant la télémétrie
+//et le bouton ; 0 -> toutes à la même priorité (mbed), pour comparer les latences
+#define PRIORITES_NVIC 1
+//Pire latence entre l'événement qui cadence le cycle (tick, ou trame publiée par
+//l'acquisition en tâche de fond) et la reprise de la boucle (DWT), affichée avec le taux d'inactivité
+#define MESURE_LATENCE 0
+//Charge de fond pour la mesure : interruption du Ticker (TIMER3) occupée 20µs toutes les 100µs
+#define CHARGE_LATENCE 0
+//Pile de main() séparée de celle des interruptions (pile.h), en octets : la profondeur
+//maximale de chacune est affichée avec le taux d'inactivité quand elle augmente
+//0 -> main() reste sur la pile des interruptions, une seule mesure pour les deux
+#define PILE_PRINCIPALE 0x1000
+
+#endif
@@ -0,0 +1,106 @@
+#ifndef PILE_H
+#define PILE_H
+
+#include "mbed.h"
+#include <stdlib.h>
+#include "parametres.h"
+
+//Occupation des piles : peinture au démarrage, puis niveau maximal atteint depuis
+//Sans RTOS, main() et les interruptions partagent la pile MSP (haut de la RAM locale,
+//le tas monte vers elle depuis la fin de RW_IRAM1)
+//Avec PILE_PRINCIPALE > 0, main() passe sur sa propre pile (PSP, tableau de
+//PILE_PRINCIPALE octets) : MSP ne sert plus qu'aux interruptions, et chacune
+//des deux piles a son niveau maximal, pour les dimensionner au plus juste
+//Le niveau maximal est le mot peint le plus bas qui a été modifié : une pile
+//qui a débordé se voit pleine
+
+#define MOTIF_PILE 0xA5A5A5A5u
+
+//Passage du mode Thread sur PSP (CONTROL.SPSEL) puis saut à fonction, sans retour :
+//aucune variable locale ne doit survivre au changement de pile
+#if defined(__CC_ARM)
+static __asm void execute_sur_psp(void (*fonction)(void), unsigned int *sommet){
+	MSR PSP, r1
+	MOVS r1, #2
+	MSR CONTROL, r1
+	ISB
+	BX r0
+}
+#else
+static inline void execute_sur_psp(void (*fonction)(void), unsigned int *sommet){
+	__asm volatile("msr psp, %1\n\tmovs r2, #2\n\tmsr control, r2\n\tisb\n\tbx %0" : : "r"(fonction), "r"(sommet) : "r2");
+}
+#endif
+
+class SurveillancePiles {
+public:
+	enum {
+		//Place laissée au tas sous la zone peinte de MSP
+		MARGE_TAS = 1024,
+		//Marge sous le cadre de la fonction qui peint
+		MARGE_CADRE = 64
+	};
+
+	//Peint les piles et exécute fonction (la suite de main()) sur la pile principale
+	void demarre(void (*fonction)(void)){
+		unsigned int *p;
+		//MSP : du tas (plus une marge pour sa croissance) jusque sous le cadre courant
+		void *sonde = malloc(4);
+		bas_msp = (unsigned int *)(((unsigned int)sonde + MARGE_TAS + 3) & ~3u);
+		free(sonde);
+		haut_msp = (unsigned int *)(__get_MSP() & ~3u);
+		for(p = bas_msp; p < haut_msp - MARGE_CADRE/4; p++)
+			*p = MOTIF_PILE;
+#if PILE_PRINCIPALE
+		for(p = pile; p < pile + PILE_PRINCIPALE/4; p++)
+			*p = MOTIF_PILE;
+		execute_sur_psp(fonction, pile + PILE_PRINCIPALE/4);
+#else
+		fonction();
+#endif
+	}
+
+	//Profondeur maximale atteinte (octets) par main() et par les interruptions
+	//Sans pile principale à part, les deux sont sur MSP : interruptions() vaut 0
+	unsigned int principale() const {
+#if PILE_PRINCIPALE
+		return utilise(pile, pile + PILE_PRINCIPALE/4);
+#else
+		return utilise(bas_msp, haut_msp);
+#endif
+	}
+	unsigned int interruptions() const {
+#if PILE_PRINCIPALE
+		return utilise(bas_msp, haut_msp);
+#else
+		return 0;
+#endif
+	}
+	//Place de la pile de main()
+	unsigned int taille_principale() const {
+#if PILE_PRINCIPALE
+		return PILE_PRINCIPALE;
+#else
+		return (unsigned int)(haut_msp - bas_msp) * 4;
+#endif
+	}
+
+private:
+	//Du bas de la zone peinte vers le haut : premier mot modifié
+	static unsigned int utilise(const unsigned int *bas, const unsigned int *haut){
+		const unsigned int *p = bas;
+		while(p < haut && *p == MOTIF_PILE)
+			p++;
+		return (unsigned int)(haut - p) * 4;
+	}
+
+	//Zone peinte de MSP
+	unsigned int *bas_msp;
+	unsigned int *haut_msp;
+#if PILE_PRINCIPALE
+	//Pile de main() (mot de 8 octets aligné : AAPCS)
+	unsigned int pile[PILE_PRINCIPALE/4] __attribute__((aligned(8)));
+#endif
+};
+
+#endif
@@ -0,0 +1,169 @@
+#ifndef PILOTAGE_H
+#define PILOTAGE_H
+
+#include "parametres.h"
+#include "decision.h"
+#include "vitesses.h"
+#include "estimation.h"
+#include "autoreglage.h"
+#include "virgule_fixe.h"
+#include "memoire.h"
+
+//Stratégies de pilotage : vitesses des moteurs à partir de la décision du cycle
+//calcule() -> décision, temps filtrés et seuils du cycle
+//droite(), gauche() -> vitesses à appliquer (‰ de la période PWM)
+//Tout le calcul est entier (virgule_fixe.h)
+
+//Vitesse d'un moteur limitée à la période PWM (‰)
+inline int borne_pour_mille(int v){
+	return borne(v, 0, 1000);
+}
+
+//Vitesses lues dans une table selon la direction (réglages d'origine)
+//ANTICIPATION : part (%) de la commande de virage estimée ajoutée à l'écart entre
+//les moteurs donné par la table. La table ne corrige qu'une fois la ligne partie
+//vers les capteurs du bord ; l'anticipation tourne dès l'entrée dans la courbe
+//et garde la ligne au centre dans les virages de rayon constant (0 : table seule,
+//sans estimateur, voir la spécialisation plus bas)
+template<class Table, int ANTICIPATION = 0, class Reglage = ReglageEstimateur>
+class PilotageTable {
+public:
+	PilotageTable() : commande(0), droite_(0), gauche_(0) {}
+
+	template<class Decision>
+	EN_RAM void calcule(const Decision &decision, const int temps_us[NB_CAPTEURS], const int seuils[NB_CAPTEURS]){
+		vitesses.calcule(decision.direction_courante());
+		int mesure = 0;
+		bool valide = decision.confiance() != CONFIANCE_NULLE && position_ligne(temps_us, seuils, mesure);
+		estimateur.cycle(valide, mesure, commande);
+
+		int virage = ANTICIPATION * estimateur.commande_virage() / 100;
+		droite_ = borne_pour_mille(vitesses.droite() + virage/2);
+		gauche_ = borne_pour_mille(vitesses.gauche() - virage/2);
+		commande = droite_ - gauche_;
+	}
+
+	int droite() const { return droite_; }
+	int gauche() const { return gauche_; }
+
+	const EstimateurLigne<Reglage> &estimation() const { return estimateur; }
+
+private:
+	Vitesses<Table> vitesses;
+	EstimateurLigne<Reglage> estimateur;
+	//Commande différentielle appliquée (droite - gauche, ‰)
+	int commande;
+	//Vitesses en ‰ avec l'anticipation
+	int droite_;
+	int gauche_;
+};
+
+//Sans anticipation : la table seule, ni estimateur ni position de la ligne calculée
+//(configurations 1, 2, 3 et 6, RAM et temps de cycle d'origine)
+template<class Table, class Reglage>
+class PilotageTable<Table, 0, Reglage> {
+public:
+	template<class Decision>
+	EN_RAM void calcule(const Decision &decision, const int[NB_CAPTEURS], const int[NB_CAPTEURS]){
+		vitesses.calcule(decision.direction_courante());
+	}
+
+	int droite() const { return vitesses.droite(); }
+	int gauche() const { return vitesses.gauche(); }
+
+private:
+	Vitesses<Table> vitesses;
+};
+
+//Commande continue proportionnelle-dérivée sur la position estimée de la ligne
+//L'estimateur (estimation.h) reçoit le barycentre des capteurs et la commande
+//du cycle précédent : la dérivée est le cap estimé et non la différence de deux
+//mesures bruitées, et la commande continue sur la trajectoire prédite quand
+//la ligne disparaît quelques cycles
+//BASE : vitesse des deux moteurs en ligne droite (‰)
+//KP   : ‰ d'écart entre les moteurs par pas de capteur d'écart latéral
+//KD   : ‰ d'écart entre les moteurs par pas/cycle de dérive
+//ANTICIPATION : part (%) de la commande de virage estimée ajoutée au correcteur ;
+//sans elle l'écart nécessaire pour tourner ne vient que de KP et KD, donc d'une
+//ligne décentrée pendant tout le virage
+//KP et KD sont les gains de départ : regle() les remplace (gains sauvegardés),
+//demarre_reglage() lance un essai en relais qui les mesure (autoreglage.h)
+template<int BASE, int KP, int KD, int ANTICIPATION = 0, class Reglage = ReglageEstimateur>
+class PilotagePD {
+public:
+	enum {
+		//Gains acceptés par regle() : écarte les gains aberrants d'un essai manqué
+		KP_MAX = 4000,
+		KD_MAX = 16000
+	};
+
+	PilotagePD() : commande(0), droite_(0), gauche_(0), kp_(KP), kd_(KD), en_reglage(false) {}
+
+	template<class Decision>
+	EN_RAM void calcule(const Decision &decision, const int temps_us[NB_CAPTEURS], const int seuils[NB_CAPTEURS]){
+		int mesure = 0;
+		bool valide = decision.confiance() != CONFIANCE_NULLE && position_ligne(temps_us, seuils, mesure);
+		estimateur.cycle(valide, mesure, commande);
+
+		//Essai en relais : les gains mesurés remplacent les gains courants à la fin
+		if(en_reglage){
+			commande = relais.commande(estimateur.position(), estimateur.cycles_sans_mesure());
+			if(relais.etat() != REGLAGE_EN_COURS){
+				en_reglage = false;
+				if(relais.etat() == REGLAGE_REUSSI)
+					regle(relais.kp(), relais.kd());
+			}
+		}
+		//Ligne à gauche (position négative) -> moteur droit plus rapide (commande positive)
+		//Gains en ‰ par pas, position et vitesse ramenées en Q16 : somme en Q16 sur 64 bits
+		else{
+			Accumulateur correction;
+			correction.ajoute(kp_, estimateur.position() >> 8);
+			correction.ajoute(kd_, estimateur.vitesse_position() >> 8);
+			commande = -correction.resultat<16>() + ANTICIPATION * estimateur.commande_virage() / 100;
+		}
+		commande = borne(commande, -2*BASE, 2*BASE);
+		droite_ = borne_pour_mille(BASE + commande/2);
+		gauche_ = borne_pour_mille(BASE - commande/2);
+		//Commande réellement appliquée, pour la prédiction du cycle suivant
+		commande = droite_ - gauche_;
+	}
+
+	int droite() const { return droite_; }
+	int gauche() const { return gauche_; }
+
+	const EstimateurLigne<Reglage> &estimation() const { return estimateur; }
+
+	//Gains du correcteur (bornés à KP_MAX, KD_MAX)
+	void regle(int kp, int kd){
+		kp_ = kp < 0 ? 0 : kp > KP_MAX ? KP_MAX : kp;
+		kd_ = kd < 0 ? 0 : kd > KD_MAX ? KD_MAX : kd;
+	}
+	int kp() const { return kp_; }
+	int kd() const { return kd_; }
+
+	//Essai en relais sur la ligne, à la place du correcteur jusqu'à sa fin
+	void demarre_reglage(){
+		relais = ReglageRelais();
+		en_reglage = true;
+	}
+	bool reglage_en_cours() const { return en_reglage; }
+	//Résultat du dernier essai (REGLAGE_EN_COURS, REGLAGE_REUSSI, REGLAGE_ECHEC)
+	const ReglageRelais &reglage() const { return relais; }
+
+private:
+	EstimateurLigne<Reglage> estimateur;
+	//Commande différentielle du cycle (droite - gauche, ‰)
+	int commande;
+	//Vitesses en ‰
+	int droite_;
+	int gauche_;
+	//Gains courants
+	int kp_;
+	int kd_;
+	//Essai de réglage
+	ReglageRelais relais;
+	bool en_reglage;
+};
+
+#endif
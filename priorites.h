@@ -0,0 +1,90 @@
+#ifndef PRIORITES_H
+#define PRIORITES_H
+
+#include "mbed.h"
+#include "parametres.h"
+
+//Plan des priorités d'interruption (NVIC du LPC1768 : 5 bits, 0 la plus haute)
+//mbed laisse toutes les interruptions à 0 : un envoi sur la liaison série ou un appui
+//sur le bouton retarde alors le tick du cycle de contrôle. Ici l'acquisition et la
+//cadence du cycle passent devant tout le reste, la télémétrie et le bouton derrière
+//Les gestionnaires de défaut (priorité fixe, négative) restent au-dessus de tout
+//Avec PRIORITES_NVIC 0, les priorités de mbed sont gardées (comparaison de latence)
+enum {
+	//TIMER2 : échantillonnage des capteurs, la résolution des temps de décharge en dépend
+	PRIORITE_ACQUISITION = 0,
+	//TIMER1 : tick du cycle de contrôle (cadence.h)
+	PRIORITE_CADENCE = 1,
+	//TIMER3 (us_ticker, Ticker et Timeout de mbed) : surveillance de la boucle, horloge
+	PRIORITE_TICKER = 2,
+	//EINT3 : toutes les broches InterruptIn, codeurs des roues et bouton
+	PRIORITE_GPIO = 3,
+	//UART0 : télémétrie
+	PRIORITE_SERIE = 4
+};
+
+inline void applique_priorites(){
+#if PRIORITES_NVIC
+	NVIC_SetPriority(TIMER2_IRQn, PRIORITE_ACQUISITION);
+	NVIC_SetPriority(TIMER1_IRQn, PRIORITE_CADENCE);
+	NVIC_SetPriority(TIMER3_IRQn, PRIORITE_TICKER);
+	NVIC_SetPriority(EINT3_IRQn, PRIORITE_GPIO);
+	NVIC_SetPriority(UART0_IRQn, PRIORITE_SERIE);
+#endif
+}
+
+//Pire latence du cycle de contrôle (MESURE_LATENCE), en cycles processeur (DWT) : temps
+//entre l'événement qui le déclenche (tick du TIMER1, ou trame publiée par l'acquisition
+//en tâche de fond) et la reprise de la boucle principale après son sommeil
+class MesureLatence {
+public:
+	MesureLatence() : debut(0), en_attente(false), periode(0), total(0) {}
+
+	//Événement qui réveille la boucle, survenu il y a retard cycles (interruption)
+	void evenement(unsigned int retard = 0){
+		debut = DWT->CYCCNT - retard;
+		en_attente = true;
+	}
+
+	//Boucle principale réveillée (interruptions masquées)
+	void reveil(){
+		if(en_attente){
+			note(DWT->CYCCNT - debut);
+			en_attente = false;
+		}
+	}
+
+	//Événement non servi avant l'arrêt des interruptions périodiques (robot garé)
+	void oublie(){
+		en_attente = false;
+	}
+
+	//Maximum depuis le dernier rapport, puis remis à zéro
+	unsigned int maximum_periode(){
+		unsigned int m = periode;
+		periode = 0;
+		return m;
+	}
+
+	//Maximum depuis le démarrage
+	unsigned int maximum() const { return total; }
+
+private:
+	void note(unsigned int cycles){
+		if(cycles > periode)
+			periode = cycles;
+		if(cycles > total)
+			total = cycles;
+	}
+
+	volatile unsigned int debut;
+	volatile bool en_attente;
+	volatile unsigned int periode;
+	volatile unsigned int total;
+};
+
+#if MESURE_LATENCE
+extern MesureLatence latence_cycle;
+#endif
+
+#endif
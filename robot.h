@@ -0,0 +1,532 @@
+#ifndef ROBOT_H
+#define ROBOT_H
+
+#include "mbed.h"
+#include "parametres.h"
+#include "capteurs.h"
+#include "controle.h"
+#include "moteurs.h"
+#include "calibrage.h"
+#include "telemetrie.h"
+#include "trace.h"
+#include "boite_noire.h"
+#include "boite_noire_vidage.h"
+#include "pile.h"
+#include "horloge.h"
+#include "surveillance.h"
+#include "cadence.h"
+#if AUTO_REGLAGE || IDENTIFICATION_MOTEURS || COMPENSATION_MOTEURS
+#include "sauvegarde.h"
+#endif
+#if CODEURS_ROUES
+#include "codeurs.h"
+#endif
+
+//Messages vers Putty
+extern Telemetrie telemetrie;
+//Boîte noire des derniers cycles
+extern BoiteNoire boite_noire;
+//Occupation des piles
+extern SurveillancePiles piles;
+//Date 64 bits depuis le démarrage
+extern Horloge horloge;
+//Surveillance de la boucle de contrôle
+extern Surveillance surveillance;
+#if IDENTIFICATION_MOTEURS
+//Identification des moteurs (2 Ko de mesures, banque AHBSRAM1)
+extern IdentificationMoteurs<!CODEURS_ROUES> identification;
+#endif
+
+//Robot suiveur de ligne assemblé à partir des étapes choisies dans Config :
+//Config::Capteurs  -> acquisition des temps de descente
+//Config::Filtre    -> filtrage du bruit des lectures
+//Config::Decision  -> choix de la direction
+//Config::Pilotage  -> vitesses des moteurs (table par direction ou commande continue)
+//Config::Calibrage -> mesure des niveaux ligne/sol avant le départ
+//Config::Seuil     -> seuils ligne/sol de chaque capteur pendant la course
+//Le choix se fait à la compilation : aucun appel virtuel dans la boucle
+//Filtre, Decision, Pilotage et Seuil forment le calcul du cycle (controle.h),
+//rejouable sur PC à partir d'une trace des capteurs (CAPTURE_TRACE)
+template<class Config>
+class Robot {
+public:
+	Robot() : date_poids_fort(0), flagTick(false), temps_sommeil_us(0), debut_rapport_us(0), numero_trace(0), entete_envoyee(false), essai_reglage(false), coupure_signalee(false),
+		cycles_min(0xFFFFFFFFu), cycles_max(0), cycles_somme(0), cycles_nombre(0), filtre_max(0), filtre_depassements(0),
+		pile_principale_max(0), pile_interruptions_max(0) {}
+
+	void init(){
+		if(surveillance.redemarrage_par_chien())
+			telemetrie.printf("Redemarrage par le chien de garde\n\r");
+		//On initialise le calibrage (bouton, LEDs témoins)
+		calibrage.init();
+		//Un appui pendant la course fige et vide la boîte noire
+		calibrage.ajoute_appui(&boite_noire, &BoiteNoire::appui);
+		controle.init(calibrage);
+#if AUTO_REGLAGE
+		//Gains trouvés lors d'un essai précédent
+		int kp, kd;
+		if(lit_gains(kp, kd))
+			controle.pilotage().regle(kp, kd);
+#endif
+		//On initialise les sorties PWM (moteurs)
+		moteurs.initPWM();
+#if COMPENSATION_MOTEURS
+		//Caractéristiques de la dernière identification des moteurs
+		CaracteristiqueMoteur droite, gauche;
+		if(lit_moteurs(droite, gauche))
+			moteurs.compense(droite, gauche);
+#endif
+#if CODEURS_ROUES
+		codeurs.demarre();
+#endif
+#if MESURE_CYCLES || MESURE_LATENCE
+		//Compteur de cycles processeur du DWT
+		CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+		DWT->CYCCNT = 0;
+		DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+		//On lance l'acquisition
+		capteurs.demarre();
+		//On cadence la boucle de contrôle (acquisition en tâche de fond : cadence des trames)
+		if(!Config::Capteurs::ASYNCHRONE)
+			cadence.attach_us(this, &Robot::tick, PERIODE_CONTROLE_US);
+#if CHARGE_LATENCE
+		charge_fond.attach_us(this, &Robot::occupe, 100);
+#endif
+	}
+
+	//Boucle principale, ne rend jamais la main
+	void boucle(){
+		while(1){
+			//Actions de l'utilisateur (bouton)
+			calibrage.evenements();
+			
+			//Robot à l'arrêt : sommeil profond jusqu'au prochain appui
+			if(calibrage.en_attente()){
+				surveillance.repos();
+				attente_bouton();
+				debut_rapport_us = horloge.us();
+				temps_sommeil_us = 0;
+			}
+			
+			//Calibrage : on mesure le temps de décharge de référence
+			else if(calibrage.en_cours()){
+				surveillance.repos();
+				capteurs.purge();
+				capteurs.lecture(temps_us);
+				calibrage.mesure(temps_us);
+				controle.init(calibrage);
+			}
+			
+#if IDENTIFICATION_MOTEURS
+			//Identification des moteurs à la place de la course
+			else
+				identifie();
+#else
+			//Fonctionnement "normal" du robot
+			else{
+				//On attend le prochain cycle en sommeil
+				attente_cycle();
+				
+				//On récupère les temps de décharge
+				capteurs.lecture(temps_us);
+				debut_enregistrement();
+#if CAPTURE_TRACE
+				envoi_trace();
+#endif
+
+				//print_temps();
+				//wait(0.5);
+				//Filtre, décision, seuils et vitesses
+#if MESURE_CYCLES
+				unsigned int debut_calcul = DWT->CYCCNT;
+				controle.filtre(temps_us);
+				compte_filtre(DWT->CYCCNT - debut_calcul);
+				controle.decide(temps_us);
+#else
+				controle.cycle(temps_us);
+#endif
+				moteurs.applique(controle.pilotage().droite(), controle.pilotage().gauche());
+				surveillance.battement();
+				signale_coupure();
+#if MESURE_CYCLES
+				compte_cycles(DWT->CYCCNT - debut_calcul);
+#endif
+#if AUTO_REGLAGE
+				reglage();
+#endif
+				
+				//Boîte noire
+				fin_enregistrement();
+				if(boite_noire.vidage_demande())
+					vidage_boite_noire();
+				
+				//Marge restante de la boucle de contrôle
+				rapport_inactivite();
+			}
+#endif
+		}
+	}
+
+	//Affiche les temps récupérés depuis les capteurs
+	void print_temps(){
+		//affichage du temps des capteurs
+		char i;
+		for(i=0;i<NB_CAPTEURS;i++){
+			telemetrie.printf("Temps du capteurs n°%d : %d\n\r",i+1,temps_us[i]);
+		}
+		telemetrie.printf("\n\n\n");
+	}
+
+private:
+	enum {
+		//PLL0STAT : PLL0 connectée (PLLC0_STAT), effacé par le sommeil profond
+		PLL0STAT_CONNECTEE = (1<<25)
+	};
+
+	//Interruption du tick de contrôle (TIMER1) : autorise un nouveau cycle de contrôle
+	void tick(){
+		flagTick = true;
+	}
+
+#if CHARGE_LATENCE
+	//Charge de fond pour la mesure de latence, à la priorité du Ticker
+	void occupe(){
+		wait_us(20);
+	}
+#endif
+
+	//Prochain cycle : tick de la cadence ou nouvelle trame de l'acquisition en tâche de fond
+	bool cycle_pret() const {
+		return Config::Capteurs::ASYNCHRONE ? capteurs.trame_prete() : flagTick;
+	}
+
+	//Mise en sommeil jusqu'au prochain cycle de contrôle
+	//Le temps passé en sommeil est comptabilisé pour le taux d'inactivité
+	void attente_cycle(){
+		//Durées courtes : la différence des us_ticker_read() sur 32 bits reste juste au passage à zéro
+		unsigned int debut;
+		//Interruptions masquées : le réveil a lieu, mais l'interruption n'est servie
+		//qu'après la mesure (son temps n'est pas compté comme inactif)
+		__disable_irq();
+		while(!cycle_pret()){
+			debut = us_ticker_read();
+			//Le cœur s'arrête, le tick, l'acquisition (ou le bouton) le réveille
+#if !BOITE_NOIRE_FICHIER
+			sleep();
+#endif
+			temps_sommeil_us += us_ticker_read() - debut;
+			__enable_irq();
+			__disable_irq();
+		}
+#if MESURE_LATENCE
+		latence_cycle.reveil();
+#endif
+		__enable_irq();
+		flagTick = false;
+	}
+
+	//Robot à l'arrêt en attente du bouton : sommeil profond
+	//Seule l'interruption du bouton (GPIO) peut réveiller le microcontrôleur : les
+	//interruptions périodiques (acquisition, tick, vérification de la surveillance) sont
+	//arrêtées pendant le sommeil, sinon WFI ressortirait aussitôt. Elles le sont avant de
+	//masquer les interruptions (Ticker::detach() les démasque) et reprennent après
+	void attente_bouton(){
+		capteurs.arrete();
+		if(!Config::Capteurs::ASYNCHRONE)
+			cadence.arrete();
+		surveillance.arrete();
+#if CHARGE_LATENCE
+		charge_fond.detach();
+#endif
+#if MESURE_LATENCE
+		latence_cycle.oublie();
+#endif
+		//On masque les interruptions pour ne pas rater un appui entre le test et le sommeil
+		//(WFI se réveille quand même sur une interruption en attente)
+		__disable_irq();
+		if(calibrage.en_attente()){
+			//SystemInit() remet les horloges des périphériques à leur valeur par défaut :
+			//on les sauvegarde (UART, PWM et timers réglés par mbed)
+			uint32_t pconp = LPC_SC->PCONP;
+			uint32_t pclksel0 = LPC_SC->PCLKSEL0;
+			uint32_t pclksel1 = LPC_SC->PCLKSEL1;
+			deepsleep();
+			//Au réveil d'un vrai sommeil profond le cœur tourne sur l'oscillateur interne,
+			//PLL0 déconnectée : on la relance avant de servir l'interruption du bouton (le
+			//calibrage utilise wait()). Si WFI est ressorti aussitôt (interruption déjà en
+			//attente), la PLL est toujours connectée et les horloges n'ont pas bougé
+			if(!(LPC_SC->PLL0STAT & PLL0STAT_CONNECTEE)){
+				SystemInit();
+				LPC_SC->PCONP = pconp;
+				LPC_SC->PCLKSEL0 = pclksel0;
+				LPC_SC->PCLKSEL1 = pclksel1;
+			}
+		}
+		__enable_irq();
+		surveillance.reprend();
+		if(!Config::Capteurs::ASYNCHRONE)
+			cadence.reprend();
+		capteurs.demarre();
+#if CHARGE_LATENCE
+		charge_fond.attach_us(this, &Robot::occupe, 100);
+#endif
+	}
+
+	//Date et temps bruts du cycle pour la boîte noire
+	void debut_enregistrement(){
+		char i;
+		unsigned long long date = horloge.us();
+		cycle.date_us = (unsigned int)date;
+		date_poids_fort = (unsigned int)(date >> 32);
+		for(i=0; i<NB_CAPTEURS; i++)
+			cycle.temps_us[i] = sature_positif<16>(temps_us[i]);
+	}
+
+	//Décision et vitesses du cycle, puis ajout dans la boîte noire
+	void fin_enregistrement(){
+		cycle.direction = controle.decision().direction_courante();
+		cycle.confiance = controle.decision().confiance();
+		cycle.masque = controle.decision().masque();
+		cycle.droite = (unsigned short)controle.pilotage().droite();
+		cycle.gauche = (unsigned short)controle.pilotage().gauche();
+		cycle.cause = boite_noire.cause();
+		boite_noire.enregistre(cycle, date_poids_fort);
+	}
+
+#if CAPTURE_TRACE
+	//Trace binaire des temps bruts pour le rejeu sur PC (outils/rejeu.cpp)
+	//L'entête (niveaux du calibrage) part avec la première trame de la course
+	//Une trame qui ne tient pas dans la file de télémétrie est perdue en entier :
+	//le numéro de trame permet au rejeu de repérer le trou
+	void envoi_trace(){
+		TrameTrace trame;
+		char i;
+		if(!entete_envoyee){
+			EnteteTrace entete = {{'T', 'R', 'C', '1'}, NB_CAPTEURS, 0, {0}, {0}};
+			entete.seuil = calibrage.seuil();
+			for(i=0; i<NB_CAPTEURS; i++){
+				entete.noir[i] = calibrage.niveau_noir(i);
+				entete.blanc[i] = calibrage.niveau_blanc(i);
+			}
+			entete_envoyee = telemetrie.ecrit(&entete, sizeof(entete));
+			if(!entete_envoyee)
+				return;
+		}
+		trame.synchro = SYNCHRO_TRACE;
+		trame.numero = numero_trace++;
+		for(i=0; i<NB_CAPTEURS; i++)
+			trame.temps_us[i] = cycle.temps_us[i];
+		trame.somme = somme_trace(trame);
+		trame.reserve = 0;
+		telemetrie.ecrit(&trame, sizeof(trame));
+	}
+#endif
+
+#if AUTO_REGLAGE
+	//Essai de réglage en relais demandé au départ (LED 21 allumée pendant l'essai)
+	//À la fin, les gains trouvés sont sauvegardés robot arrêté, puis la course continue
+	void reglage(){
+		if(calibrage.reglage_demande()){
+			controle.pilotage().demarre_reglage();
+			essai_reglage = true;
+			LPC_GPIO1->FIOCLR = (1<<21);
+			return;
+		}
+		if(!essai_reglage || controle.pilotage().reglage_en_cours())
+			return;
+		essai_reglage = false;
+		LPC_GPIO1->FIOSET = (1<<21);
+		const ReglageRelais &essai = controle.pilotage().reglage();
+		if(essai.etat() != REGLAGE_REUSSI){
+			telemetrie.printf("Reglage : echec, gains inchanges\n\r");
+			return;
+		}
+		moteurs.arret();
+		surveillance.repos();
+		bool sauve = sauve_gains(controle.pilotage().kp(), controle.pilotage().kd());
+		//Trames perdues pendant l'écriture de la flash
+		capteurs.purge();
+		flagTick = false;
+		telemetrie.printf("Reglage : Tu %d cycles, a %d/1000 pas -> KP %d KD %d%s\n\r",
+			essai.periode(), (essai.amplitude()*1000) >> 12, controle.pilotage().kp(), controle.pilotage().kd(),
+			sauve ? "" : " (non sauvegardes)");
+	}
+#endif
+
+#if IDENTIFICATION_MOTEURS
+	//Un cycle de l'identification des moteurs : PWM sans compensation, puis
+	//affichage et sauvegarde des caractéristiques, robot arrêté
+	void identifie(){
+		int pwm_droite, pwm_gauche;
+		attente_cycle();
+		capteurs.lecture(temps_us);
+		if(identification.terminee())
+			return;
+		//Temps filtrés et seuils suivis comme en course
+		controle.cycle(temps_us);
+#if CODEURS_ROUES
+		identification.cycle(true, codeurs.position(MOTEUR_DROIT), codeurs.position(MOTEUR_GAUCHE), pwm_droite, pwm_gauche);
+#else
+		int position = 0;
+		bool valide = controle.decision().confiance() != CONFIANCE_NULLE && position_ligne(temps_us, controle.seuil().seuils(), position);
+		identification.cycle(valide, position, position, pwm_droite, pwm_gauche);
+#endif
+		moteurs.applique_pwm(pwm_droite, pwm_gauche);
+		surveillance.battement();
+		signale_coupure();
+		if(!identification.analyse_en_attente())
+			return;
+
+		//Ajustement de l'échelon (bien plus long qu'un cycle) moteurs arrêtés, hors
+		//surveillance : le battement du cycle suivant la réarme
+		moteurs.arret();
+		surveillance.repos();
+		identification.termine_echelon();
+		capteurs.purge();
+		if(!identification.terminee())
+			return;
+
+		if(!identification.reussie()){
+			telemetrie.printf("Identification : echec\n\r");
+			return;
+		}
+		const CaracteristiqueMoteur &droite = identification.caracteristique(MOTEUR_DROIT);
+		const CaracteristiqueMoteur &gauche = identification.caracteristique(MOTEUR_GAUCHE);
+		bool sauve = sauve_moteurs(droite, gauche);
+		capteurs.purge();
+		telemetrie.printf("Moteur droit : zone morte %d/1000, gain %d, tau %d us\n\r", droite.zone_morte, droite.gain, droite.constante_temps);
+		telemetrie.printf("Moteur gauche : zone morte %d/1000, gain %d, tau %d us%s\n\r", gauche.zone_morte, gauche.gain, gauche.constante_temps,
+			sauve ? "" : " (non sauvegardes)");
+	}
+#endif
+
+	//Robot arrêté, la boîte noire est envoyée sur la liaison série (et dans un fichier)
+	void vidage_boite_noire(){
+		moteurs.arret();
+		surveillance.repos();
+		telemetrie.attente_envoi();
+		vide_boite_serie(boite_noire);
+#if BOITE_NOIRE_FICHIER
+		vide_boite_fichier(boite_noire, "/local/boite.bin");
+#endif
+		boite_noire.rearme();
+	}
+
+	//Coupure des moteurs par la surveillance, signalée une fois quand la boucle reprend
+	void signale_coupure(){
+		if(surveillance.moteurs_coupes() && !coupure_signalee){
+			coupure_signalee = true;
+			telemetrie.printf("Echeance manquee : moteurs coupes apres %u us sans cycle\n\r", surveillance.retard_coupure_us());
+		}
+	}
+
+	//Affiche périodiquement le pourcentage de temps CPU passé en sommeil
+	//(et la durée du calcul des cycles avec MESURE_CYCLES)
+	void rapport_inactivite(){
+		unsigned long long maintenant = horloge.us();
+		unsigned int duree = (unsigned int)(maintenant - debut_rapport_us);
+		if(duree >= PERIODE_RAPPORT_US){
+			unsigned int date_ms = (unsigned int)(maintenant / 1000);
+			telemetrie.printf("[%u.%03u s] CPU inactif : %d%%\n\r", date_ms/1000, date_ms%1000, (int)((unsigned long long)temps_sommeil_us*100/duree));
+#if MESURE_CYCLES
+			//Une ligne par emplacement du code : comparer une compilation CODE_EN_RAM 1 et 0
+			if(cycles_nombre)
+				telemetrie.printf("Calcul du cycle, code en %s : min %u moy %u max %u cycles CPU\n\r", CODE_EN_RAM ? "RAM" : "flash",
+					cycles_min, cycles_somme/cycles_nombre, cycles_max);
+			cycles_min = 0xFFFFFFFFu;
+			cycles_max = cycles_somme = cycles_nombre = 0;
+			telemetrie.printf("Filtre : max %u cycles CPU (%u us), budget %u us%s (%u depassements)\n\r", filtre_max,
+				filtre_max / (SystemCoreClock/1000000), BUDGET_FILTRE_US, filtre_depassements ? " DEPASSE" : " respecte", filtre_depassements);
+			filtre_max = filtre_depassements = 0;
+#endif
+#if MESURE_LATENCE
+			//Comparer PRIORITES_NVIC 1 et 0, avec et sans CHARGE_LATENCE
+			telemetrie.printf("Latence trame -> cycle de controle : max %u cycles CPU (%u depuis le demarrage), priorites %s, charge %s\n\r",
+				latence_cycle.maximum_periode(), latence_cycle.maximum(), PRIORITES_NVIC ? "plan" : "mbed", CHARGE_LATENCE ? "oui" : "non");
+#endif
+			rapport_piles();
+			temps_sommeil_us = 0;
+			debut_rapport_us = horloge.us();
+		}
+	}
+
+	//Profondeur maximale des piles, affichée seulement quand elle a augmenté
+	void rapport_piles(){
+		unsigned int principale = piles.principale(), interruptions = piles.interruptions();
+		if(principale > pile_principale_max || interruptions > pile_interruptions_max){
+			pile_principale_max = principale;
+			pile_interruptions_max = interruptions;
+#if PILE_PRINCIPALE
+			telemetrie.printf("Piles : main %u/%u octets, interruptions %u octets\n\r", principale, piles.taille_principale(), interruptions);
+#else
+			telemetrie.printf("Pile : %u/%u octets\n\r", principale, piles.taille_principale());
+#endif
+		}
+	}
+
+#if MESURE_CYCLES
+	void compte_cycles(unsigned int cycles){
+		if(cycles < cycles_min)
+			cycles_min = cycles;
+		if(cycles > cycles_max)
+			cycles_max = cycles;
+		cycles_somme += cycles;
+		cycles_nombre++;
+	}
+
+	//Durée du filtre seul face à BUDGET_FILTRE_US
+	void compte_filtre(unsigned int cycles){
+		if(cycles > filtre_max)
+			filtre_max = cycles;
+		if(cycles > BUDGET_FILTRE_US * (SystemCoreClock/1000000))
+			filtre_depassements++;
+	}
+#endif
+
+	//Étapes du robot
+	typename Config::Capteurs capteurs;
+	Controle<Config> controle;
+	Moteurs moteurs;
+	typename Config::Calibrage calibrage;
+#if CODEURS_ROUES
+	CodeursRoues codeurs;
+#endif
+
+	//Tableau temps de descente de chaque capteur
+	int temps_us[NB_CAPTEURS];
+	//Cycle en cours pour la boîte noire, 32 bits de poids fort de sa date
+	Enregistrement cycle;
+	unsigned int date_poids_fort;
+	//Tick cadençant la boucle de contrôle
+	CadenceControle cadence;
+#if CHARGE_LATENCE
+	Ticker charge_fond;
+#endif
+	//Flag levé à chaque tick de contrôle
+	volatile bool flagTick;
+	//Temps passé en sommeil depuis le dernier rapport
+	unsigned int temps_sommeil_us;
+	//Date du dernier rapport d'inactivité
+	unsigned long long debut_rapport_us;
+	//Trace des capteurs : numéro de la prochaine trame, entête déjà envoyée
+	unsigned char numero_trace;
+	bool entete_envoyee;
+	//Essai de réglage en cours
+	bool essai_reglage;
+	//Coupure par la surveillance déjà signalée
+	bool coupure_signalee;
+	//Durée du calcul des cycles depuis le dernier rapport (cycles processeur)
+	unsigned int cycles_min;
+	unsigned int cycles_max;
+	unsigned int cycles_somme;
+	unsigned int cycles_nombre;
+	//Durée maximale du filtre (cycles processeur) et dépassements du budget depuis le dernier rapport
+	unsigned int filtre_max;
+	unsigned int filtre_depassements;
+	//Profondeur maximale des piles au dernier rapport
+	unsigned int pile_principale_max;
+	unsigned int pile_interruptions_max;
+};
+
+#endif
@@ -0,0 +1,141 @@
+#ifndef SAUVEGARDE_H
+#define SAUVEGARDE_H
+
+#include "mbed.h"
+#include <string.h>
+#include "identification.h"
+
+//Sauvegarde des réglages d'une course à l'autre (gains du pilotage, caractéristiques
+//des moteurs) dans le dernier secteur de la flash (secteur 29, 32 Ko à 0x78000, retiré
+//du programme dans LPC1768.sct), écrit par les routines IAP de la ROM du LPC1768
+//Le robot roule sur batterie : le LocalFileSystem (interface mbed alimentée par l'USB,
+//et déconnectée par sleep()) n'est pas utilisable en course
+//L'effacement du secteur prend environ 100 ms interruptions masquées (la flash,
+//donc la table des vecteurs, est inaccessible pendant l'IAP) : robot arrêté
+//L'IAP utilise les 32 derniers octets de la RAM locale, c'est-à-dire le fond de la pile :
+//seuls les cadres de démarrage y sont, main() ne rend jamais la main
+
+#define SECTEUR_SAUVEGARDE 29
+#define ADRESSE_SAUVEGARDE 0x78000
+
+//Point d'entrée des routines IAP (Thumb) et commandes utilisées
+#define ADRESSE_IAP 0x1FFF1FF1
+enum {
+	IAP_PREPARE = 50,
+	IAP_COPIE = 51,
+	IAP_EFFACE = 52,
+	IAP_SUCCES = 0
+};
+
+//Le secteur commence par un bloc de 256 octets (la plus petite écriture IAP) :
+//chaque réglage y a sa marque et son contrôle, et se lit indépendamment des autres
+//Enregistrer un réglage réécrit le bloc en gardant les autres
+
+//Gains du correcteur PD (autoreglage.h)
+struct GainsSauvegardes {
+	char magie[4];		//"GPD1"
+	int kp;
+	int kd;
+	unsigned int controle;
+};
+
+//Caractéristiques des moteurs (identification.h)
+struct MoteursSauvegardes {
+	char magie[4];		//"MOT1"
+	CaracteristiqueMoteur moteurs[2];
+	unsigned int controle;
+};
+
+struct BlocSauvegarde {
+	GainsSauvegardes gains;
+	MoteursSauvegardes moteurs;
+};
+
+typedef void (*EntreeIAP)(unsigned int commande[5], unsigned int resultat[5]);
+
+//Contrôle d'un réglage : somme pondérée de ses mots (la flash effacée vaut 0xFF partout)
+inline unsigned int controle_sauvegarde(const void *donnees, int taille){
+	const unsigned int *mots = (const unsigned int *)donnees;
+	unsigned int somme = 0x5A5A5A5Au;
+	int i;
+	for(i=0; i<taille/4; i++)
+		somme = somme*31u + mots[i];
+	return somme;
+}
+
+inline const BlocSauvegarde &bloc_sauvegarde(){
+	return *(const BlocSauvegarde *)ADRESSE_SAUVEGARDE;
+}
+
+//Gains de la dernière sauvegarde (false si le secteur est vide ou invalide)
+inline bool lit_gains(int &kp, int &kd){
+	const GainsSauvegardes &g = bloc_sauvegarde().gains;
+	if(memcmp(g.magie, "GPD1", 4) != 0 || g.controle != controle_sauvegarde(&g, sizeof(g) - 4))
+		return false;
+	kp = g.kp;
+	kd = g.kd;
+	return true;
+}
+
+//Caractéristiques des moteurs de la dernière identification
+inline bool lit_moteurs(CaracteristiqueMoteur &droite, CaracteristiqueMoteur &gauche){
+	const MoteursSauvegardes &m = bloc_sauvegarde().moteurs;
+	if(memcmp(m.magie, "MOT1", 4) != 0 || m.controle != controle_sauvegarde(&m, sizeof(m) - 4))
+		return false;
+	droite = m.moteurs[MOTEUR_DROIT];
+	gauche = m.moteurs[MOTEUR_GAUCHE];
+	return true;
+}
+
+//Appel d'une commande IAP, renvoie son code de retour
+inline unsigned int iap(unsigned int c0, unsigned int c1, unsigned int c2, unsigned int c3, unsigned int c4){
+	unsigned int commande[5] = {c0, c1, c2, c3, c4}, resultat[5];
+	((EntreeIAP)ADRESSE_IAP)(commande, resultat);
+	return resultat[0];
+}
+
+//Source des écritures : RAM alignée sur un mot, initialisée avec le bloc en flash
+inline unsigned int *copie_bloc(){
+	static unsigned int bloc[64];
+	memcpy(bloc, (const void *)ADRESSE_SAUVEGARDE, sizeof(bloc));
+	return bloc;
+}
+
+//Efface le secteur et y écrit le bloc
+inline bool ecrit_bloc(const unsigned int bloc[64]){
+	unsigned int khz = SystemCoreClock / 1000;
+	bool ok;
+	__disable_irq();
+	ok = iap(IAP_PREPARE, SECTEUR_SAUVEGARDE, SECTEUR_SAUVEGARDE, 0, 0) == IAP_SUCCES
+		&& iap(IAP_EFFACE, SECTEUR_SAUVEGARDE, SECTEUR_SAUVEGARDE, khz, 0) == IAP_SUCCES
+		&& iap(IAP_PREPARE, SECTEUR_SAUVEGARDE, SECTEUR_SAUVEGARDE, 0, 0) == IAP_SUCCES
+		&& iap(IAP_COPIE, ADRESSE_SAUVEGARDE, (unsigned int)bloc, 64*4, khz) == IAP_SUCCES;
+	__enable_irq();
+	return ok;
+}
+
+inline bool sauve_gains(int kp, int kd){
+	unsigned int *bloc = copie_bloc();
+	GainsSauvegardes &g = ((BlocSauvegarde *)bloc)->gains;
+	int lu_kp, lu_kd;
+	memcpy(g.magie, "GPD1", 4);
+	g.kp = kp;
+	g.kd = kd;
+	g.controle = controle_sauvegarde(&g, sizeof(g) - 4);
+	//Relecture de la flash
+	return ecrit_bloc(bloc) && lit_gains(lu_kp, lu_kd) && lu_kp == kp && lu_kd == kd;
+}
+
+inline bool sauve_moteurs(const CaracteristiqueMoteur &droite, const CaracteristiqueMoteur &gauche){
+	unsigned int *bloc = copie_bloc();
+	MoteursSauvegardes &m = ((BlocSauvegarde *)bloc)->moteurs;
+	CaracteristiqueMoteur lu_droite, lu_gauche;
+	memcpy(m.magie, "MOT1", 4);
+	m.moteurs[MOTEUR_DROIT] = droite;
+	m.moteurs[MOTEUR_GAUCHE] = gauche;
+	m.controle = controle_sauvegarde(&m, sizeof(m) - 4);
+	return ecrit_bloc(bloc) && lit_moteurs(lu_droite, lu_gauche)
+		&& memcmp(&lu_droite, &droite, sizeof(droite)) == 0 && memcmp(&lu_gauche, &gauche, sizeof(gauche)) == 0;
+}
+
+#endif
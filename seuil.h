@@ -0,0 +1,107 @@
+#ifndef SEUIL_H
+#define SEUIL_H
+
+#include "decision.h"
+#include "memoire.h"
+
+//Stratégies de seuil ligne/sol, un seuil par capteur
+//init()    -> reprend les niveaux noir/blanc mesurés par le calibrage
+//adapte()  -> mise à jour à partir de la dernière décision
+//seuils()  -> seuils à utiliser pour la prochaine décision
+
+//Seuil du calibrage, identique pour tous les capteurs et figé pendant la course
+class SeuilFixe {
+public:
+	template<class Calibrage>
+	void init(const Calibrage &calibrage){
+		char i;
+		for(i=0; i<NB_CAPTEURS; i++)
+			seuils_[i] = calibrage.seuil();
+	}
+
+	void adapte(const int temps_us[NB_CAPTEURS], int masque, int confiance){}
+
+	const int *seuils() const { return seuils_; }
+
+private:
+	int seuils_[NB_CAPTEURS];
+};
+
+//Suivi en course des niveaux noir et blanc de chaque capteur (recalibrage en ligne)
+//Seules les lectures d'un motif "propre" (CONFIANCE_FORTE) sont utilisées :
+//le capteur est alors sûrement sur la ligne (blanc) ou sur le sol (noir)
+//Chaque niveau suit la lecture avec un lissage de 1/2^VITESSE, et sa variation est
+//bornée à PAS_MAX_US par cycle ; ligne perdue ou motif douteux -> niveaux figés
+//Le seuil de chaque capteur est le milieu de ses deux niveaux
+template<int VITESSE>
+class SeuilAdaptatif {
+public:
+	template<class Calibrage>
+	void init(const Calibrage &calibrage){
+		char i;
+		for(i=0; i<NB_CAPTEURS; i++){
+			noir[i] = calibrage.niveau_noir(i) << FRACTION;
+			blanc[i] = calibrage.niveau_blanc(i) << FRACTION;
+			calcule_seuil(i);
+		}
+	}
+
+	EN_RAM void adapte(const int temps_us[NB_CAPTEURS], int masque, int confiance){
+		char i;
+		//Motif douteux ou ligne perdue : on ne suit pas, pour ne pas dériver
+		if(confiance != CONFIANCE_FORTE)
+			return;
+		for(i=0; i<NB_CAPTEURS; i++){
+			if(masque & (1 << i)){
+				blanc[i] += pas(temps_us[i], blanc[i]);
+				//Le blanc reste sous le noir d'au moins ECART_MIN_US
+				if(blanc[i] > noir[i] - (ECART_MIN_US << FRACTION))
+					blanc[i] = noir[i] - (ECART_MIN_US << FRACTION);
+			}
+			else{
+				noir[i] += pas(temps_us[i], noir[i]);
+				if(noir[i] < blanc[i] + (ECART_MIN_US << FRACTION))
+					noir[i] = blanc[i] + (ECART_MIN_US << FRACTION);
+			}
+			calcule_seuil(i);
+		}
+	}
+
+	const int *seuils() const { return seuils_; }
+
+	//Niveaux courants (µs) pour la télémétrie
+	int niveau_noir(int i) const { return noir[i] >> FRACTION; }
+	int niveau_blanc(int i) const { return blanc[i] >> FRACTION; }
+
+private:
+	enum {
+		//Bits de fraction des niveaux (virgule fixe)
+		FRACTION = 4,
+		//Variation maximale d'un niveau en un cycle
+		PAS_MAX_US = 4,
+		//Écart minimal entre niveau noir et niveau blanc
+		ECART_MIN_US = 50
+	};
+
+	//Pas de lissage vers la lecture, borné
+	static int pas(int temps, int niveau){
+		int p = ((temps << FRACTION) - niveau) >> VITESSE;
+		if(p > (PAS_MAX_US << FRACTION))
+			p = PAS_MAX_US << FRACTION;
+		else if(p < -(PAS_MAX_US << FRACTION))
+			p = -(PAS_MAX_US << FRACTION);
+		return p;
+	}
+
+	void calcule_seuil(int i){
+		seuils_[i] = (noir[i] + blanc[i]) >> (FRACTION + 1);
+	}
+
+	//Niveaux noir et blanc en virgule fixe
+	int noir[NB_CAPTEURS];
+	int blanc[NB_CAPTEURS];
+	//Seuils courants
+	int seuils_[NB_CAPTEURS];
+};
+
+#endif
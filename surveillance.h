@@ -0,0 +1,131 @@
+#ifndef SURVEILLANCE_H
+#define SURVEILLANCE_H
+
+#include "mbed.h"
+#include "parametres.h"
+#include "boite_noire.h"
+#include "moteurs.h"
+
+//Surveillance de la boucle de contrôle : si la boucle se bloque (capteur débranché,
+//attente ou printf bloquant), la dernière PWM reste appliquée et le robot part tout droit
+//La boucle donne un battement à chaque cycle de course (battement()) ; une interruption
+//du Ticker vérifie toutes les millisecondes que le dernier date de moins de
+//ECHEANCE_CYCLE_US + DELAI_COUPURE_MS. Sinon les sorties E1/E2 sont coupées
+//(Moteurs::coupe_sorties), la boîte noire est figée (GEL_ECHEANCE) et le robot reste
+//arrêté jusqu'au prochain démarrage. Robot à l'arrêt (attente, calibrage, sauvegarde
+//en flash, vidage de la boîte noire), repos() suspend la vérification
+//Si la vérification elle-même ne tourne plus (interruption bloquée, interruptions
+//masquées), le chien de garde matériel (WDT), nourri par elle, redémarre le
+//microcontrôleur après DELAI_CHIEN_DE_GARDE_MS : la cause est lue au démarrage
+//Le WDT compte sur l'horloge des périphériques, arrêtée en sommeil profond
+//(attente du bouton) : il ne redémarre pas le robot qui attend. La vérification, elle,
+//réveillerait le robot toutes les millisecondes : arrete() la retire avant le sommeil
+class Surveillance {
+public:
+	Surveillance(BoiteNoire &boite) : boite(boite), dernier_battement(0), battements(0), arme(false), coupe(false),
+		retard_us(0), redemarrage_chien(false) {}
+
+	//Chien de garde matériel et vérification périodique
+	void demarre(){
+		//Redémarrage précédent provoqué par le chien de garde
+		redemarrage_chien = (LPC_WDT->WDMOD & WDTOF) != 0;
+		LPC_WDT->WDMOD &= ~WDTOF;
+		LPC_WDT->WDCLKSEL = WDCLKSEL_PCLK;
+		LPC_WDT->WDTC = coups_wdt(DELAI_CHIEN_DE_GARDE_MS);
+		LPC_WDT->WDMOD = WDEN | WDRESET;
+		nourrit();
+		verification.attach_us(this, &Surveillance::verifie, PERIODE_VERIFICATION_US);
+	}
+
+	//Fin d'un cycle de course : la vérification est armée
+	void battement(){
+		dernier_battement = us_ticker_read();
+		battements++;
+		arme = true;
+	}
+
+	//Robot arrêté, ou opération longue moteurs arrêtés : plus d'échéance
+	void repos(){
+		arme = false;
+	}
+
+	//Robot garé : plus de vérification (ni de réveil) jusqu'à reprend() ; le chien de
+	//garde est nourri une dernière fois et ne compte qu'éveillé
+	void arrete(){
+		arme = false;
+		verification.detach();
+		nourrit();
+	}
+
+	void reprend(){
+		nourrit();
+		verification.attach_us(this, &Surveillance::verifie, PERIODE_VERIFICATION_US);
+	}
+
+	//Attente très longue, interruptions masquées (vidage depuis un gestionnaire de défaut) :
+	//le chien de garde est repoussé au maximum (plusieurs minutes)
+	void suspend_chien(){
+		LPC_WDT->WDTC = 0xFFFFFFFFu;
+		nourrit();
+	}
+
+	bool moteurs_coupes() const { return coupe; }
+	//Cycles de course depuis le démarrage
+	unsigned int cycles() const { return battements; }
+	//Temps écoulé depuis le dernier battement au moment de la coupure
+	unsigned int retard_coupure_us() const { return retard_us; }
+	//Le démarrage fait suite à un redémarrage par le chien de garde
+	bool redemarrage_par_chien() const { return redemarrage_chien; }
+
+private:
+	enum {
+		//Registres du WDT
+		WDEN = (1<<0),
+		WDRESET = (1<<1),
+		WDTOF = (1<<2),
+		WDCLKSEL_PCLK = 1,
+		//Vérification toutes les millisecondes : coupure au plus 1 ms après le délai
+		PERIODE_VERIFICATION_US = 1000
+	};
+
+	//Valeur de WDTC pour un délai en ms : le WDT compte à PCLK_WDT / 4
+	static unsigned int coups_wdt(unsigned int ms){
+		static const unsigned char diviseurs[4] = {4, 1, 2, 8};
+		unsigned int pclk = SystemCoreClock / diviseurs[LPC_SC->PCLKSEL0 & 3];
+		return ms * (pclk / 4 / 1000);
+	}
+
+	//Séquence d'alimentation du WDT, à ne pas entrecouper d'un autre accès au WDT
+	void nourrit(){
+		uint32_t primask = __get_PRIMASK();
+		__disable_irq();
+		LPC_WDT->WDFEED = 0xAA;
+		LPC_WDT->WDFEED = 0x55;
+		__set_PRIMASK(primask);
+	}
+
+	//Interruption du Ticker
+	void verifie(){
+		if(arme && !coupe){
+			unsigned int retard = us_ticker_read() - dernier_battement;
+			if(retard > ECHEANCE_CYCLE_US + DELAI_COUPURE_MS * 1000){
+				Moteurs::coupe_sorties();
+				coupe = true;
+				retard_us = retard;
+				boite.fige(GEL_ECHEANCE);
+			}
+		}
+		nourrit();
+	}
+
+	BoiteNoire &boite;
+	Ticker verification;
+	volatile unsigned int dernier_battement;
+	unsigned int battements;
+	volatile bool arme;
+	volatile bool coupe;
+	unsigned int retard_us;
+	bool redemarrage_chien;
+};
+
+#endif
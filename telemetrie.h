@@ -0,0 +1,104 @@
+#ifndef TELEMETRIE_H
+#define TELEMETRIE_H
+
+#include "mbed.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include "fifo.h"
+
+//Envoi des messages sur la liaison série (Putty) sans bloquer la boucle de contrôle
+//printf() dépose le texte dans une file, vidée par l'interruption d'émission de l'UART0
+//(USBTX/USBRX) : la boucle produit, l'interruption consomme
+//Si la file est pleine, les caractères en trop sont perdus (et comptés)
+//La file est fournie par l'appelant (banque AHBSRAM1 dans main.cpp)
+
+#define TAILLE_TELEMETRIE 512
+typedef FileSPSC<char, TAILLE_TELEMETRIE> FileTelemetrie;
+
+class Telemetrie {
+public:
+	Telemetrie(Serial &port, FileTelemetrie &file) : port(port), file(file), perdus(0) {}
+
+	void demarre(){
+		//mbed active l'interruption d'émission : on ne la garde que lorsqu'il y a à envoyer
+		port.attach(this, &Telemetrie::emission, Serial::TxIrq);
+		LPC_UART0->IER &= ~IER_THRE;
+	}
+
+	void printf(const char *format, ...){
+		char texte[TAILLE_MESSAGE];
+		int n, i;
+		va_list arguments;
+		va_start(arguments, format);
+		n = vsnprintf(texte, sizeof(texte), format, arguments);
+		va_end(arguments);
+		if(n > (int)sizeof(texte) - 1)
+			n = sizeof(texte) - 1;
+		for(i=0; i<n; i++)
+			if(!file.ajoute(texte[i]))
+				perdus++;
+		relance();
+	}
+
+	//Données binaires (trace des capteurs) : envoyées en entier ou pas du tout,
+	//pour que le récepteur ne voie jamais de bloc tronqué
+	bool ecrit(const void *donnees, int n){
+		const char *octets = (const char *)donnees;
+		int i;
+		if(TAILLE_TELEMETRIE - file.nombre() < n){
+			perdus += n;
+			return false;
+		}
+		for(i=0; i<n; i++)
+			file.ajoute(octets[i]);
+		relance();
+		return true;
+	}
+
+	//Attend que tous les messages soient partis (avant une écriture directe dans l'UART)
+	void attente_envoi(){
+		while(!file.vide());
+	}
+
+	//Nombre de caractères perdus (file pleine)
+	unsigned int octets_perdus() const { return perdus; }
+
+private:
+	enum {
+		TAILLE_MESSAGE = 128,
+		//FIFO d'émission matérielle de l'UART
+		FIFO_UART = 16,
+		IER_THRE = (1<<1),
+		LSR_THRE = (1<<5)
+	};
+
+	//Relance l'émission si l'UART est au repos
+	//L'interruption d'émission est coupée le temps de remplir la FIFO matérielle :
+	//la boucle est alors le seul consommateur de la file
+	void relance(){
+		LPC_UART0->IER &= ~IER_THRE;
+		emission();
+	}
+
+	//Interruption "FIFO d'émission vide" : on envoie la suite
+	void emission(){
+		char c;
+		int n = 0;
+		if(LPC_UART0->LSR & LSR_THRE)
+			while(n < FIFO_UART && file.retire(c)){
+				LPC_UART0->THR = c;
+				n++;
+			}
+		if(file.vide())
+			LPC_UART0->IER &= ~IER_THRE;
+		else
+			LPC_UART0->IER |= IER_THRE;
+	}
+
+	Serial &port;
+	//Caractères à envoyer
+	FileTelemetrie &file;
+	unsigned int perdus;
+};
+
+#endif
@@ -0,0 +1,39 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include "parametres.h"
+
+//Format binaire des traces de capteurs envoyées sur la liaison série (CAPTURE_TRACE)
+//et rejouées sur PC (outils/rejeu.cpp)
+//Une entête avec les niveaux du calibrage, puis une trame par cycle de contrôle
+//avec les temps bruts, avant filtrage
+
+#define SYNCHRO_TRACE 0xA5
+
+struct EnteteTrace {
+	char magie[4];			//"TRC1"
+	unsigned short nombre_capteurs;
+	unsigned short seuil;
+	unsigned short noir[NB_CAPTEURS];
+	unsigned short blanc[NB_CAPTEURS];
+};
+
+struct TrameTrace {
+	unsigned char synchro;		//SYNCHRO_TRACE
+	unsigned char numero;		//compteur de trames, pour repérer les pertes
+	unsigned short temps_us[NB_CAPTEURS];
+	unsigned char somme;		//somme des octets précédents
+	unsigned char reserve;
+};
+
+//Somme de contrôle d'une trame
+inline unsigned char somme_trace(const TrameTrace &t){
+	const unsigned char *octets = (const unsigned char *)&t;
+	unsigned char somme = 0;
+	unsigned int i;
+	for(i=0; i<(unsigned int)((const unsigned char *)&t.somme - octets); i++)
+		somme += octets[i];
+	return somme;
+}
+
+#endif
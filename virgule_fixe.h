@@ -0,0 +1,126 @@
+#ifndef VIRGULE_FIXE_H
+#define VIRGULE_FIXE_H
+
+//Calcul en virgule fixe pour le cycle de contrôle : le Cortex-M3 n'a pas d'unité
+//flottante, chaque opération sur un float est un appel de bibliothèque de plusieurs
+//dizaines de cycles (centaines pour un double)
+//Format Qn : entier signé 32 bits dont les n bits de poids faible sont la partie fractionnaire
+//La saturation utilise les instructions SSAT/USAT (core_cmInstr.h, un cycle) ;
+//sur PC (outils) un équivalent portable donne les mêmes résultats
+//outils/verifie_entiers.cpp vérifie qu'aucun flottant ne reste dans le cycle
+
+#if defined(__CC_ARM) || defined(__arm__)
+#include "cmsis.h"
+#define SATURATION_CORTEX 1
+#else
+#define SATURATION_CORTEX 0
+#endif
+
+//Constante réelle en Qn arrondie au plus proche, calculée à la compilation
+//(x doit être une constante : aucun flottant n'est évalué à l'exécution)
+#define EN_Q(x, n) ((int)((x) * (double)(1 << (n)) + ((x) < 0 ? -0.5 : 0.5)))
+
+//Saturation sur BITS bits signés : [-2^(BITS-1), 2^(BITS-1) - 1]
+template<int BITS>
+inline int sature(int x){
+#if SATURATION_CORTEX
+	return (int)__SSAT(x, BITS);
+#else
+	const int max = (int)((1u << (BITS - 1)) - 1);
+	return x > max ? max : x < -max - 1 ? -max - 1 : x;
+#endif
+}
+
+//Saturation sur BITS bits non signés : [0, 2^BITS - 1]
+template<int BITS>
+inline int sature_positif(int x){
+#if SATURATION_CORTEX
+	return (int)__USAT(x, BITS);
+#else
+	const int max = (int)((1u << BITS) - 1);
+	return x > max ? max : x < 0 ? 0 : x;
+#endif
+}
+
+//Bornes quelconques (pas d'instruction dédiée : deux comparaisons)
+inline int borne(int x, int min, int max){
+	return x < min ? min : x > max ? max : x;
+}
+
+//Résultat 64 bits ramené sur 32 bits
+inline int sature32(long long x){
+	return x > 0x7FFFFFFFLL ? 0x7FFFFFFF : x < -0x7FFFFFFFLL - 1 ? -0x7FFFFFFF - 1 : (int)x;
+}
+
+//Décalage à droite de N bits arrondi au plus proche (les demis vers +infini)
+template<int N>
+inline long long arrondi(long long x){
+	return (x + (1LL << (N - 1))) >> N;
+}
+template<>
+inline long long arrondi<0>(long long x){
+	return x;
+}
+
+//Produit d'un Qa par un Qb ramené en Qr (r <= a + b), arrondi et saturé
+//Le produit intermédiaire est sur 64 bits (SMULL) : pas de débordement
+template<int A, int B, int R>
+inline int produit(int x, int y){
+	return sature32(arrondi<A + B - R>((long long)x * y));
+}
+
+//Somme de produits sur 64 bits (multiplication-accumulation SMLAL) :
+//les produits en Q(a+b) s'ajoutent sans débordement, puis un seul décalage
+class Accumulateur {
+public:
+	Accumulateur() : somme(0) {}
+
+	void ajoute(int x, int y){
+		somme += (long long)x * y;
+	}
+
+	//Somme décalée de N bits (vers -infini, comme >>), saturée sur 32 bits
+	template<int N>
+	int resultat() const {
+		return sature32(somme >> N);
+	}
+
+private:
+	long long somme;
+};
+
+//Racine carrée entière (partie entière), bit par bit : une racine de Q2n est un Qn
+inline unsigned int racine(unsigned int x){
+	unsigned int r = 0, bit = 1u << 30;
+	while(bit > x)
+		bit >>= 2;
+	while(bit){
+		if(x >= r + bit){
+			x -= r + bit;
+			r = (r >> 1) + bit;
+		}
+		else
+			r >>= 1;
+		bit >>= 2;
+	}
+	return r;
+}
+
+//Même calcul sur 64 bits (carré d'une valeur Q12 qui dépasse 2^31)
+inline unsigned int racine(unsigned long long x){
+	unsigned long long r = 0, bit = 1ull << 62;
+	while(bit > x)
+		bit >>= 2;
+	while(bit){
+		if(x >= r + bit){
+			x -= r + bit;
+			r = (r >> 1) + bit;
+		}
+		else
+			r >>= 1;
+		bit >>= 2;
+	}
+	return (unsigned int)r;
+}
+
+#endif
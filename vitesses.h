@@ -0,0 +1,86 @@
+#ifndef VITESSES_H
+#define VITESSES_H
+
+#include "memoire.h"
+
+//Tables de vitesses {droite, gauche} indexées par la direction (-3 à 3),
+//en ‰ de la période PWM
+//forte  -> premier réglage, "forte" correction de la trajectoire
+//faible -> réglage suivant plus atténué
+
+//Vitesses de l'ancien main1.cpp
+struct VitessesConfig1 {
+	static const short *forte(int dir){
+		static const short t[7][2] = {
+			{400, 0}, {500, 100}, {700, 400}, {600, 600}, {400, 700}, {100, 500}, {0, 400}
+		};
+		return (dir < -3 || dir > 3) ? 0 : t[dir+3];
+	}
+	static const short *faible(int dir){
+		static const short t[7][2] = {
+			{500, 200}, {600, 200}, {700, 600}, {600, 600}, {600, 700}, {200, 600}, {200, 500}
+		};
+		return (dir < -3 || dir > 3) ? 0 : t[dir+3];
+	}
+};
+
+//Vitesses de l'ancien main2.cpp
+struct VitessesConfig2 {
+	static const short *forte(int dir){
+		static const short t[7][2] = {
+			{800, 400}, {800, 500}, {800, 700}, {800, 800}, {700, 800}, {500, 800}, {400, 800}
+		};
+		return (dir < -3 || dir > 3) ? 0 : t[dir+3];
+	}
+	static const short *faible(int dir){
+		static const short t[7][2] = {
+			{800, 650}, {800, 700}, {800, 750}, {800, 800}, {750, 800}, {700, 800}, {650, 800}
+		};
+		return (dir < -3 || dir > 3) ? 0 : t[dir+3];
+	}
+};
+
+//Calcul de la puissance des moteurs en fonction de la direction à prendre
+//Indépendant du matériel (PWM appliquée par Moteurs)
+template<class Table>
+class Vitesses {
+public:
+	Vitesses() : count_follow(0), vitesse_droite(0), vitesse_gauche(0) {}
+
+	EN_RAM void calcule(int dir){
+		const short *v = 0;
+
+		//La première partie, "forte" correction de la trajectoire (80%)
+		//Ensuite, correction plus atténuée (20%)
+		//Évite une forte "oscillation" autour de la ligne
+		if(count_follow < 40){
+			v = Table::forte(dir);
+			count_follow++;
+		}
+		//Réglage suivant plus faible
+		else if(count_follow > 40 && count_follow < 50){
+			v = Table::faible(dir);
+			count_follow++;
+		}
+		else
+			count_follow = 0;
+
+		//Sans nouvelle consigne on garde les vitesses précédentes
+		if(v){
+			vitesse_droite = v[0];
+			vitesse_gauche = v[1];
+		}
+	}
+
+	int droite() const { return vitesse_droite; }
+	int gauche() const { return vitesse_gauche; }
+
+private:
+	//Variable réglage "fort" ou non de la direction
+	int count_follow;
+	//Vitesse à appliquer à chaque moteur (‰)
+	int vitesse_droite;
+	int vitesse_gauche;
+};
+
+#endif